@@ -25,6 +25,7 @@
 #include <boost/graph/tway_color.hpp>
 #include <boost/graph/tway_relax.hpp>
 #include <boost/graph/tway_breadth_first_visit.hpp>
+#include <boost/graph/tway_queue.hpp>
 
 namespace boost {
 
@@ -85,6 +86,43 @@ tway_astar_visitor<Visitors> make_tway_astar_visitor(Visitors vis)
 typedef tway_astar_visitor<> default_tway_astar_visitor;
 
 
+/**
+ * tway_meeting: best meeting of a best meeting search, the edge source to
+ *   target joining a forward labelled source to a backward labelled target,
+ *   cost is d_f(source) + w + d_b(target); a nonzero stretch keeps the search
+ *   going until the keys pass cost * (1 + stretch), so the labels also hold
+ *   the near optimal meetings
+ */
+template <class Vertex, class Distance>
+struct tway_meeting {
+	tway_meeting(Distance inf, double s = 0) : cost(inf), source(), target(), found(false), stretch(s) {}
+	Distance slack() const {
+		return static_cast<Distance>(cost * stretch);
+	}
+	Distance cost;
+	Vertex source;
+	Vertex target;
+	bool found;
+	double stretch;
+};
+
+/**
+ * tway_search_side: queue and labels of one side of a best meeting search,
+ *   the two sides keep theirs apart so a vertex can carry both
+ */
+template <class Queue, class PredecessorMap, class CostMap, class DistanceMap, class ColorMap>
+struct tway_search_side {
+	typedef CostMap CostMapType;
+	typedef ColorMap ColorMapType;
+	tway_search_side(Queue& q, PredecessorMap p, CostMap c, DistanceMap d, ColorMap col)
+		: Q(q), predecessor(p), cost(c), distance(d), color(col) {}
+	Queue& Q;
+	PredecessorMap predecessor;
+	CostMap cost;
+	DistanceMap distance;
+	ColorMap color;
+};
+
 namespace detail {
 
 template <class TwAStarHeuristic, class UniformCostVisitor,
@@ -276,6 +314,226 @@ private:
 
 } // namespace detail
 
+/**
+ * tway_astar_search_no_init_with_queue: caller supplies the updatable queue
+ *   ordered on the cost map, so queue storage can be reused across searches
+ */
+template <typename VertexListGraph, typename TwAStarHeuristic,
+         typename TwAStarVisitor, typename UpdatableQueue,
+         typename PredecessorMap, typename CostMap,
+         typename DistanceMap, typename WeightMap, typename ColorMap,
+         typename CompareFunction, typename CombineFunction,
+         typename CostInf, typename CostZero>
+inline void tway_astar_search_no_init_with_queue (VertexListGraph &g,
+        typename graph_traits<VertexListGraph>::vertex_descriptor s,
+        typename graph_traits<VertexListGraph>::vertex_descriptor t,
+        TwAStarHeuristic h_f,
+        TwAStarHeuristic h_r,
+        TwAStarVisitor vis, UpdatableQueue& Q,
+        PredecessorMap predecessor, CostMap cost,
+        DistanceMap distance, WeightMap weight,
+        ColorMap color,
+        CompareFunction compare, CombineFunction combine,
+        CostInf inf, CostZero zero)
+{
+	tway_astar_search_no_init_with_queue(g, s, t, h_f, h_r, vis, Q, predecessor, cost, distance, weight,
+	                                     color, compare, combine, inf, zero, tway_all_edges());
+}
+
+/**
+ * tway_astar_search_no_init_with_queue: as above, edges for which keep(e,
+ *   is_fwd) is false are not followed
+ */
+template <typename VertexListGraph, typename TwAStarHeuristic,
+         typename TwAStarVisitor, typename UpdatableQueue,
+         typename PredecessorMap, typename CostMap,
+         typename DistanceMap, typename WeightMap, typename ColorMap,
+         typename CompareFunction, typename CombineFunction,
+         typename CostInf, typename CostZero, typename EdgeFilter>
+inline void tway_astar_search_no_init_with_queue (VertexListGraph &g,
+        typename graph_traits<VertexListGraph>::vertex_descriptor s,
+        typename graph_traits<VertexListGraph>::vertex_descriptor t,
+        TwAStarHeuristic h_f,
+        TwAStarHeuristic h_r,
+        TwAStarVisitor vis, UpdatableQueue& Q,
+        PredecessorMap predecessor, CostMap cost,
+        DistanceMap distance, WeightMap weight,
+        ColorMap color,
+        CompareFunction compare, CombineFunction combine,
+        CostInf inf, CostZero zero, EdgeFilter keep)
+{
+	bool is_fwd=true;
+	detail::tway_astar_tbfs_visitor<TwAStarHeuristic, TwAStarVisitor,
+	       UpdatableQueue, PredecessorMap, CostMap, DistanceMap,
+	       WeightMap, ColorMap, CombineFunction, CompareFunction>
+	       tbfs_vis(h_f,h_r, vis, Q, predecessor, cost, distance, weight,
+	                color, combine, compare, zero, is_fwd);
+
+	tway_breadth_first_visit(g, s, t, Q, tbfs_vis, color, is_fwd, tway_never_stop(), keep);
+}
+
+namespace detail {
+
+/**
+ * tway_meeting_relax: edge e from u to v on the side here, relaxed into the
+ *   labels of that side alone; when the other side has labelled v the path
+ *   through e is offered to meet, as forward edge u,v or backward edge v,u
+ */
+template <class Graph, class Edge, class Side, class TwAStarHeuristic, class TwAStarVisitor,
+         class WeightMap, class CompareFunction, class CombineFunction, class Meeting>
+inline void tway_meeting_relax(const Graph& g, Edge e,
+                               typename graph_traits<Graph>::vertex_descriptor u,
+                               typename graph_traits<Graph>::vertex_descriptor v, bool is_fwd,
+                               Side& here, Side& there, TwAStarHeuristic h, TwAStarVisitor& vis,
+                               WeightMap weight, CompareFunction compare, CombineFunction combine,
+                               typename property_traits<WeightMap>::value_type zero, Meeting& meet)
+{
+	typedef typename property_traits<typename Side::ColorMapType>::value_type ColorValue;
+	typedef color_traits<ColorValue> Color;
+	typedef typename property_traits<WeightMap>::value_type D;
+	if (compare(get(weight, e), zero)) throw negative_edge();
+	vis.examine_edge(e, g);
+	D dv = combine(get(here.distance, u), get(weight, e));
+	if (!(get(there.color, v) == Color::white())) {
+		D c = combine(dv, get(there.distance, v));
+		if (!meet.found || compare(c, meet.cost)) {
+			meet.cost = c;
+			meet.source = (is_fwd) ? u : v;
+			meet.target = (is_fwd) ? v : u;
+			meet.found = true;
+		}
+	}
+	ColorValue v_color = get(here.color, v);
+	if (!(v_color == Color::white()) && !compare(dv, get(here.distance, v))) {
+		vis.edge_not_relaxed(e, g);
+		return;
+	}
+	put(here.distance, v, dv);
+	put(here.predecessor, v, u);
+	put(here.cost, v, combine(dv, h(v)));
+	if (v_color == Color::gray()) {
+		here.Q.update(v);
+	} else {
+		put(here.color, v, (is_fwd) ? Color::silver_gray() : Color::gold_gray());
+		vis.discover_vertex(v, g);
+		here.Q.push(v);
+	}
+	vis.edge_relaxed(e, g);
+}
+
+} // namespace detail
+
+/**
+ * tway_astar_search_best_meeting: tway search with one queue and one set of
+ *   labels per side, fwd from s over out edges keyed d_f + h_f, rev from t
+ *   over in edges keyed d_b + h_r, so a vertex can be labelled from both.
+ *   Every relaxation reaching a vertex the other side has labelled offers
+ *   its path to meet. policy picks the side to expand, TWAY_BALANCE_KEY the
+ *   one whose top key is further below its stop; the search returns once
+ *   that top key reaches meet.cost plus h_f(t) forward or h_r(s) backward,
+ *   or a side runs dry. With consistent heuristics each side settles exact
+ *   labels in key order, so no path is shorter than meet.cost: its first
+ *   vertex the stopping side has not settled would have a smaller key. The
+ *   path is the fwd predecessor chain of meet.source back to s followed by
+ *   the rev predecessor chain of meet.target on to t, s == t meets there at
+ *   zero. is_fwd tells the visitor the side of each event.
+ */
+template <typename VertexListGraph, typename TwAStarHeuristic,
+         typename TwAStarVisitor, typename SearchSide, typename WeightMap,
+         typename CompareFunction, typename CombineFunction,
+         typename CostZero, typename Meeting>
+inline bool tway_astar_search_best_meeting (VertexListGraph &g,
+        typename graph_traits<VertexListGraph>::vertex_descriptor s,
+        typename graph_traits<VertexListGraph>::vertex_descriptor t,
+        TwAStarHeuristic h_f,
+        TwAStarHeuristic h_r,
+        TwAStarVisitor vis, SearchSide fwd, SearchSide rev,
+        WeightMap weight, CompareFunction compare, CombineFunction combine,
+        CostZero zero, tway_balance_policy policy, Meeting& meet, bool& is_fwd)
+{
+	return tway_astar_search_best_meeting(g, s, t, h_f, h_r, vis, fwd, rev, weight, compare, combine,
+	                                      zero, policy, meet, is_fwd, tway_all_edges());
+}
+
+/**
+ * tway_astar_search_best_meeting: as above, edges for which keep(e, is_fwd)
+ *   is false are not followed
+ */
+template <typename VertexListGraph, typename TwAStarHeuristic,
+         typename TwAStarVisitor, typename SearchSide, typename WeightMap,
+         typename CompareFunction, typename CombineFunction,
+         typename CostZero, typename Meeting, typename EdgeFilter>
+inline bool tway_astar_search_best_meeting (VertexListGraph &g,
+        typename graph_traits<VertexListGraph>::vertex_descriptor s,
+        typename graph_traits<VertexListGraph>::vertex_descriptor t,
+        TwAStarHeuristic h_f,
+        TwAStarHeuristic h_r,
+        TwAStarVisitor vis, SearchSide fwd, SearchSide rev,
+        WeightMap weight, CompareFunction compare, CombineFunction combine,
+        CostZero zero, tway_balance_policy policy, Meeting& meet, bool& is_fwd, EdgeFilter keep)
+{
+	typedef graph_traits<VertexListGraph> GTraits;
+	typedef typename GTraits::vertex_descriptor Vertex;
+	typedef typename property_traits<typename SearchSide::ColorMapType>::value_type ColorValue;
+	typedef color_traits<ColorValue> Color;
+	typedef typename property_traits<typename SearchSide::CostMapType>::value_type C;
+	C offset_f = h_f(t), offset_r = h_r(s);
+	if (s == t) {
+		meet.cost = zero;
+		meet.source = meet.target = s;
+		return meet.found = true;
+	}
+	put(fwd.distance, s, zero);
+	put(fwd.cost, s, h_f(s));
+	put(fwd.color, s, Color::silver_gray());
+	vis.discover_vertex(s, g);
+	fwd.Q.push(s);
+	put(rev.distance, t, zero);
+	put(rev.cost, t, h_r(t));
+	put(rev.color, t, Color::gold_gray());
+	vis.discover_vertex(t, g);
+	rev.Q.push(t);
+	is_fwd = false;
+	while (!fwd.Q.empty() && !rev.Q.empty()) {
+		switch (policy) {
+		case TWAY_BALANCE_ALTERNATE:
+			is_fwd = !is_fwd;
+			break;
+		case TWAY_BALANCE_SIZE:
+			is_fwd = !(rev.Q.size() < fwd.Q.size());
+			break;
+		default:
+			is_fwd = !compare(combine(get(rev.cost, rev.Q.top()), offset_f),
+			                  combine(get(fwd.cost, fwd.Q.top()), offset_r));
+			break;
+		}
+		SearchSide& here = (is_fwd) ? fwd : rev;
+		SearchSide& there = (is_fwd) ? rev : fwd;
+		Vertex u = here.Q.top();
+		if (meet.found && !compare(get(here.cost, u),
+		                           combine(combine(meet.cost, meet.slack()), (is_fwd) ? offset_f : offset_r)))
+			break;
+		here.Q.pop();
+		put(here.color, u, (is_fwd) ? Color::silver_black() : Color::gold_black());
+		vis.examine_vertex(u, g);
+		if (is_fwd) {
+			typename GTraits::out_edge_iterator ei, ei_end;
+			for (tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei)
+				if (keep(*ei, true))
+					detail::tway_meeting_relax(g, *ei, u, target(*ei, g), true, here, there, h_f, vis,
+					                           weight, compare, combine, zero, meet);
+		} else {
+			typename GTraits::in_edge_iterator ei, ei_end;
+			for (tie(ei, ei_end) = in_edges(u, g); ei != ei_end; ++ei)
+				if (keep(*ei, false))
+					detail::tway_meeting_relax(g, *ei, u, source(*ei, g), false, here, there, h_r, vis,
+					                           weight, compare, combine, zero, meet);
+		}
+		vis.finish_vertex(u, g);
+	}
+	return meet.found;
+}
+
 template <typename VertexListGraph, typename TwAStarHeuristic,
          typename TwAStarVisitor, typename PredecessorMap,
          typename CostMap, typename DistanceMap,
@@ -303,14 +561,9 @@ inline void tway_astar_search_no_init (VertexListGraph &g,
 	typedef mutable_queue<Vertex, std::vector<Vertex>, IndirectCmp, VertexIndexMap> MutableQueue;
 	MutableQueue Q(num_vertices(g), icmp, index_map);
 
-	bool is_fwd=true;
-	detail::tway_astar_tbfs_visitor<TwAStarHeuristic, TwAStarVisitor,
-	       MutableQueue, PredecessorMap, CostMap, DistanceMap,
-	       WeightMap, ColorMap, CombineFunction, CompareFunction>
-	       tbfs_vis(h_f,h_r, vis, Q, predecessor, cost, distance, weight,
-	                color, combine, compare, zero, is_fwd);
-
-	tway_breadth_first_visit(g, s, t, Q, tbfs_vis, color, is_fwd);
+	tway_astar_search_no_init_with_queue
+	(g, s, t, h_f, h_r, vis, Q, predecessor, cost, distance, weight,
+	 color, compare, combine, inf, zero);
 }
 
 // Non-named parameter interface
@@ -66,12 +66,63 @@ struct TBFSVisitorConcept {
  */
 
 
+/**
+ * tway_never_stop: stop predicate of the plain visits, runs until the queue
+ *                  is empty or a visitor throws
+ */
+struct tway_never_stop {
+	template <class Vertex>
+	bool operator()(const Vertex&) const {
+		return false;
+	}
+};
+
+/**
+ * tway_all_edges: edge filter of the plain visits, every edge is followed
+ */
+struct tway_all_edges {
+	template <class Edge>
+	bool operator()(const Edge&, bool) const {
+		return true;
+	}
+};
+
 template <class BidirectionalGraph, class Buffer, class TBFSVisitor, class ColorMap>
 void tway_breadth_first_visit(
     const BidirectionalGraph& g,
     typename graph_traits<BidirectionalGraph>::vertex_descriptor s,
     typename graph_traits<BidirectionalGraph>::vertex_descriptor t,
     Buffer& Q, TBFSVisitor vis, ColorMap color, bool& is_fwd)
+{
+	tway_breadth_first_visit(g, s, t, Q, vis, color, is_fwd, tway_never_stop(), tway_all_edges());
+}
+
+/**
+ * tway_breadth_first_visit: as above, stop(u) is asked for the queue top u
+ *   before it is popped, returning true ends the visit with u still queued
+ */
+template <class BidirectionalGraph, class Buffer, class TBFSVisitor, class ColorMap, class StopPredicate>
+void tway_breadth_first_visit(
+    const BidirectionalGraph& g,
+    typename graph_traits<BidirectionalGraph>::vertex_descriptor s,
+    typename graph_traits<BidirectionalGraph>::vertex_descriptor t,
+    Buffer& Q, TBFSVisitor vis, ColorMap color, bool& is_fwd, StopPredicate stop)
+{
+	tway_breadth_first_visit(g, s, t, Q, vis, color, is_fwd, stop, tway_all_edges());
+}
+
+/**
+ * tway_breadth_first_visit: as above, keep(e, is_fwd) is asked for every
+ *   out edge of a silver vertex (is_fwd true) and in edge of a gold one,
+ *   false skips the edge before it is examined, e.g. to prune by arc flags
+ */
+template <class BidirectionalGraph, class Buffer, class TBFSVisitor, class ColorMap, class StopPredicate,
+         class EdgeFilter>
+void tway_breadth_first_visit(
+    const BidirectionalGraph& g,
+    typename graph_traits<BidirectionalGraph>::vertex_descriptor s,
+    typename graph_traits<BidirectionalGraph>::vertex_descriptor t,
+    Buffer& Q, TBFSVisitor vis, ColorMap color, bool& is_fwd, StopPredicate stop, EdgeFilter keep)
 {
 	function_requires< BidirectionalGraphConcept<BidirectionalGraph> >();
 	typedef graph_traits<BidirectionalGraph> GTraits;
@@ -92,12 +143,14 @@ void tway_breadth_first_visit(
 	Q.push(t);
 	while (! Q.empty()) {
 		Vertex u = Q.top();
+		if (stop(u)) break;
 		Q.pop();
 		is_fwd = ( get(color, u) == Color::silver());
 		vis.examine_vertex(u, g);
 		if (is_fwd) {
 			out_edge_iterator ei, ei_end;
 			for (tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				if (!keep(*ei, true)) continue;
 				Vertex v = target(*ei, g);
 				vis.examine_edge(*ei, g);
 				ColorValue v_color = get(color, v);
@@ -117,6 +170,7 @@ void tway_breadth_first_visit(
 		} else {
 			in_edge_iterator ei, ei_end;
 			for (tie(ei, ei_end) = in_edges(u, g); ei != ei_end; ++ei) {
+				if (!keep(*ei, false)) continue;
 				Vertex v = source(*ei, g);
 				vis.examine_edge(*ei, g);
 				ColorValue v_color = get(color, v);
@@ -139,6 +193,54 @@ void tway_breadth_first_visit(
 	} // end while
 } // tway_breadth_first_visit
 
+/**
+ * tway_breadth_first_visit_until: one directional visit with the events of
+ *   boost::breadth_first_visit, stop(u) is asked for the queue top u before
+ *   it is popped, returning true ends the visit with u still queued
+ */
+template <class IncidenceGraph, class Buffer, class BFSVisitor, class ColorMap, class StopPredicate>
+void tway_breadth_first_visit_until(
+    const IncidenceGraph& g,
+    typename graph_traits<IncidenceGraph>::vertex_descriptor s,
+    Buffer& Q, BFSVisitor vis, ColorMap color, StopPredicate stop)
+{
+	function_requires< IncidenceGraphConcept<IncidenceGraph> >();
+	typedef graph_traits<IncidenceGraph> GTraits;
+	typedef typename GTraits::vertex_descriptor Vertex;
+	typedef typename property_traits<ColorMap>::value_type ColorValue;
+	typedef color_traits<ColorValue> Color;
+	typename GTraits::out_edge_iterator ei, ei_end;
+
+	put(color, s, Color::gray());
+	vis.discover_vertex(s, g);
+	Q.push(s);
+	while (! Q.empty()) {
+		Vertex u = Q.top();
+		if (stop(u)) break;
+		Q.pop();
+		vis.examine_vertex(u, g);
+		for (tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+			Vertex v = target(*ei, g);
+			vis.examine_edge(*ei, g);
+			ColorValue v_color = get(color, v);
+			if (v_color == Color::white()) {
+				vis.tree_edge(*ei, g);
+				put(color, v, Color::gray());
+				vis.discover_vertex(v, g);
+				Q.push(v);
+			} else {
+				vis.non_tree_edge(*ei, g);
+				if (v_color == Color::gray())
+					vis.gray_target(*ei, g);
+				else
+					vis.black_target(*ei, g);
+			}
+		} // end for
+		put(color, u, Color::black());
+		vis.finish_vertex(u, g);
+	} // end while
+} // tway_breadth_first_visit_until
+
 template <class Visitors = null_visitor>
 class tbfs_visitor {
 public:
@@ -0,0 +1,462 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+
+// read only compressed sparse row graph for tway algos
+
+#ifndef BOOST_GRAPH_TWAY_CSR_GRAPH_HPP
+#define BOOST_GRAPH_TWAY_CSR_GRAPH_HPP
+
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <limits>
+#include <boost/config.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/properties.hpp>
+#include <boost/property_map/property_map.hpp>
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/iterator/counting_iterator.hpp>
+#include <stdint.h>
+
+namespace boost {
+
+/**
+ * tway_csr_arc: one input arc used to build a tway_csr_graph
+ */
+template <class Vertex, class Weight>
+struct tway_csr_arc {
+	tway_csr_arc() : src(0), trg(0), weight(0) {}
+	tway_csr_arc(Vertex s, Vertex t, Weight w) : src(s), trg(t), weight(w) {}
+	Vertex src;
+	Vertex trg;
+	Weight weight;
+};
+
+/**
+ * tway_csr_edge: edge descriptor, idx is the position in the forward arrays
+ *                for edges reached through out_edges and in_edges alike
+ */
+template <class Vertex, class EdgeIndex>
+struct tway_csr_edge {
+	tway_csr_edge() : src(0), trg(0), idx(0) {}
+	tway_csr_edge(Vertex s, Vertex t, EdgeIndex i) : src(s), trg(t), idx(i) {}
+	inline bool operator==(const tway_csr_edge& e) const {
+		return idx == e.idx;
+	}
+	inline bool operator!=(const tway_csr_edge& e) const {
+		return idx != e.idx;
+	}
+	Vertex src;
+	Vertex trg;
+	EdgeIndex idx;
+};
+
+namespace detail {
+
+/** tway_csr_out_edge_iterator: walks targets[offsets[u] .. offsets[u+1]) */
+template <class Vertex, class EdgeIndex>
+class tway_csr_out_edge_iterator
+	: public iterator_facade<tway_csr_out_edge_iterator<Vertex,EdgeIndex>,
+	  tway_csr_edge<Vertex,EdgeIndex>, std::random_access_iterator_tag,
+	  tway_csr_edge<Vertex,EdgeIndex>, std::ptrdiff_t> {
+public:
+	typedef tway_csr_edge<Vertex,EdgeIndex> edge_type;
+	tway_csr_out_edge_iterator() : m_src(0), m_idx(0), m_targets(0) {}
+	tway_csr_out_edge_iterator(Vertex src, EdgeIndex idx, const Vertex* targets)
+		: m_src(src), m_idx(idx), m_targets(targets) {}
+private:
+	friend class ::boost::iterator_core_access;
+	edge_type dereference() const {
+		return edge_type(m_src, m_targets[m_idx], m_idx);
+	}
+	bool equal(const tway_csr_out_edge_iterator& o) const {
+		return m_idx == o.m_idx;
+	}
+	void increment() {
+		++m_idx;
+	}
+	void decrement() {
+		--m_idx;
+	}
+	void advance(std::ptrdiff_t n) {
+		m_idx += n;
+	}
+	std::ptrdiff_t distance_to(const tway_csr_out_edge_iterator& o) const {
+		return (std::ptrdiff_t)o.m_idx - (std::ptrdiff_t)m_idx;
+	}
+	Vertex m_src;
+	EdgeIndex m_idx;
+	const Vertex* m_targets;
+};
+
+/** tway_csr_in_edge_iterator: walks the mirrored reverse arrays of v */
+template <class Vertex, class EdgeIndex>
+class tway_csr_in_edge_iterator
+	: public iterator_facade<tway_csr_in_edge_iterator<Vertex,EdgeIndex>,
+	  tway_csr_edge<Vertex,EdgeIndex>, std::random_access_iterator_tag,
+	  tway_csr_edge<Vertex,EdgeIndex>, std::ptrdiff_t> {
+public:
+	typedef tway_csr_edge<Vertex,EdgeIndex> edge_type;
+	tway_csr_in_edge_iterator() : m_trg(0), m_pos(0), m_sources(0), m_edges(0) {}
+	tway_csr_in_edge_iterator(Vertex trg, EdgeIndex pos, const Vertex* sources, const EdgeIndex* edges)
+		: m_trg(trg), m_pos(pos), m_sources(sources), m_edges(edges) {}
+private:
+	friend class ::boost::iterator_core_access;
+	edge_type dereference() const {
+		return edge_type(m_sources[m_pos], m_trg, m_edges[m_pos]);
+	}
+	bool equal(const tway_csr_in_edge_iterator& o) const {
+		return m_pos == o.m_pos;
+	}
+	void increment() {
+		++m_pos;
+	}
+	void decrement() {
+		--m_pos;
+	}
+	void advance(std::ptrdiff_t n) {
+		m_pos += n;
+	}
+	std::ptrdiff_t distance_to(const tway_csr_in_edge_iterator& o) const {
+		return (std::ptrdiff_t)o.m_pos - (std::ptrdiff_t)m_pos;
+	}
+	Vertex m_trg;
+	EdgeIndex m_pos;
+	const Vertex* m_sources;
+	const EdgeIndex* m_edges;
+};
+
+} // namespace detail
+
+/**
+ * tway_csr_graph: read only bidirectional graph in compressed sparse row form.
+ *   Forward: offsets (V+1), targets (E), weights (E)
+ *   Reverse: rev_offsets (V+1), rev_sources (E), rev_edges (E) mapping each
+ *   reverse slot back to its forward edge index, so there is a single copy
+ *   of the weights.
+ *   The arrays are either built and owned (assign, adopt) or borrowed (attach).
+ */
+template <class Vertex = uint32_t, class Weight = uint32_t, class EdgeIndex = uint32_t>
+class tway_csr_graph {
+public:
+	typedef Vertex vertex_descriptor;
+	typedef tway_csr_edge<Vertex,EdgeIndex> edge_descriptor;
+	typedef Weight weight_type;
+	typedef EdgeIndex edge_index_type;
+	typedef tway_csr_arc<Vertex,Weight> arc_type;
+	typedef bidirectional_tag directed_category;
+	typedef allow_parallel_edge_tag edge_parallel_category;
+	struct traversal_category
+		: public virtual bidirectional_graph_tag,
+		  public virtual vertex_list_graph_tag {};
+	typedef std::size_t vertices_size_type;
+	typedef std::size_t edges_size_type;
+	typedef std::size_t degree_size_type;
+	typedef detail::tway_csr_out_edge_iterator<Vertex,EdgeIndex> out_edge_iterator;
+	typedef detail::tway_csr_in_edge_iterator<Vertex,EdgeIndex> in_edge_iterator;
+	typedef counting_iterator<Vertex> vertex_iterator;
+	typedef void adjacency_iterator;
+	typedef void edge_iterator;
+
+	/** weight_map_type: edge weight read from the forward weights array */
+	struct weight_map_type {
+		typedef edge_descriptor key_type;
+		typedef Weight value_type;
+		typedef Weight reference;
+		typedef readable_property_map_tag category;
+		weight_map_type() : m_w(0) {}
+		weight_map_type(const Weight* w) : m_w(w) {}
+		friend inline Weight get(const weight_map_type& pm, const edge_descriptor& e) {
+			return pm.m_w[e.idx];
+		}
+	private:
+		const Weight* m_w;
+	};
+
+	tway_csr_graph() : m_n(0), m_m(0) {
+		point_to_storage();
+	}
+	tway_csr_graph(const tway_csr_graph& o) {
+		*this = o;
+	}
+	tway_csr_graph& operator=(const tway_csr_graph& o) {
+		if (this==&o) return *this;
+		m_n = o.m_n;
+		m_m = o.m_m;
+		m_s_offsets = o.m_s_offsets;
+		m_s_targets = o.m_s_targets;
+		m_s_weights = o.m_s_weights;
+		m_s_rev_offsets = o.m_s_rev_offsets;
+		m_s_rev_sources = o.m_s_rev_sources;
+		m_s_rev_edges = o.m_s_rev_edges;
+		if (o.owns_storage()) point_to_storage();
+		else attach(o.m_n, o.m_m, o.m_offsets, o.m_targets, o.m_weights,
+			            o.m_rev_offsets, o.m_rev_sources, o.m_rev_edges);
+		return *this;
+	}
+	~tway_csr_graph() {}
+
+	static vertex_descriptor null_vertex() {
+		return (std::numeric_limits<Vertex>::max)();
+	}
+
+	/**
+	 * assign: build from n vertices and an arc range, replacing the contents.
+	 *         arcs keep their input order within each vertex
+	 */
+	template <class ArcIterator>
+	void assign(std::size_t n, ArcIterator first, ArcIterator last) {
+		std::size_t m = std::distance(first, last);
+		m_s_offsets.assign(n+1, 0);
+		m_s_rev_offsets.assign(n+1, 0);
+		m_s_targets.resize(m);
+		m_s_weights.resize(m);
+		m_s_rev_sources.resize(m);
+		m_s_rev_edges.resize(m);
+		for (ArcIterator it=first; it!=last; ++it) {
+			++m_s_offsets[it->src+1];
+			++m_s_rev_offsets[it->trg+1];
+		}
+		for (std::size_t i=0; i<n; ++i) {
+			m_s_offsets[i+1] += m_s_offsets[i];
+			m_s_rev_offsets[i+1] += m_s_rev_offsets[i];
+		}
+		std::vector<EdgeIndex> fill(m_s_offsets.begin(), m_s_offsets.end()-1);
+		for (ArcIterator it=first; it!=last; ++it) {
+			EdgeIndex e = fill[it->src]++;
+			m_s_targets[e] = it->trg;
+			m_s_weights[e] = it->weight;
+		}
+		fill.assign(m_s_rev_offsets.begin(), m_s_rev_offsets.end()-1);
+		for (std::size_t u=0; u<n; ++u) {
+			for (EdgeIndex e=m_s_offsets[u]; e<m_s_offsets[u+1]; ++e) {
+				EdgeIndex r = fill[m_s_targets[e]]++;
+				m_s_rev_sources[r] = (Vertex)u;
+				m_s_rev_edges[r] = e;
+			}
+		}
+		m_n = n;
+		m_m = m;
+		point_to_storage();
+	}
+	/**
+	 * adopt: take arrays built elsewhere (e.g. by a parallel loader) by swap,
+	 *        the same layout as assign builds, the vectors come back empty
+	 */
+	void adopt(std::size_t n,
+	           std::vector<EdgeIndex>& offsets, std::vector<Vertex>& targets, std::vector<Weight>& weights,
+	           std::vector<EdgeIndex>& rev_offsets, std::vector<Vertex>& rev_sources, std::vector<EdgeIndex>& rev_edges) {
+		m_s_offsets.swap(offsets);
+		m_s_targets.swap(targets);
+		m_s_weights.swap(weights);
+		m_s_rev_offsets.swap(rev_offsets);
+		m_s_rev_sources.swap(rev_sources);
+		m_s_rev_edges.swap(rev_edges);
+		std::vector<EdgeIndex>().swap(offsets);
+		std::vector<Vertex>().swap(targets);
+		std::vector<Weight>().swap(weights);
+		std::vector<EdgeIndex>().swap(rev_offsets);
+		std::vector<Vertex>().swap(rev_sources);
+		std::vector<EdgeIndex>().swap(rev_edges);
+		m_n = n;
+		m_m = m_s_targets.size();
+		point_to_storage();
+	}
+	/**
+	 * attach: view arrays owned elsewhere (e.g. a mapped snapshot) without
+	 *         copying, the memory must outlive the graph
+	 */
+	void attach(std::size_t n, std::size_t m,
+	            const EdgeIndex* offsets, const Vertex* targets, const Weight* weights,
+	            const EdgeIndex* rev_offsets, const Vertex* rev_sources, const EdgeIndex* rev_edges) {
+		std::vector<EdgeIndex>().swap(m_s_offsets);
+		std::vector<Vertex>().swap(m_s_targets);
+		std::vector<Weight>().swap(m_s_weights);
+		std::vector<EdgeIndex>().swap(m_s_rev_offsets);
+		std::vector<Vertex>().swap(m_s_rev_sources);
+		std::vector<EdgeIndex>().swap(m_s_rev_edges);
+		m_n = n;
+		m_m = m;
+		m_offsets = offsets;
+		m_targets = targets;
+		m_weights = weights;
+		m_rev_offsets = rev_offsets;
+		m_rev_sources = rev_sources;
+		m_rev_edges = rev_edges;
+	}
+
+	/**
+	 * view: borrow the arrays of o with another weights array of the same
+	 *       length, nothing is copied
+	 */
+	void view(const tway_csr_graph& o, const Weight* weights) {
+		attach(o.m_n, o.m_m, o.m_offsets, o.m_targets, weights,
+		       o.m_rev_offsets, o.m_rev_sources, o.m_rev_edges);
+	}
+
+	std::size_t num_vertices() const {
+		return m_n;
+	}
+	std::size_t num_edges() const {
+		return m_m;
+	}
+	weight_map_type weight_map() const {
+		return weight_map_type(m_weights);
+	}
+	Weight weight(EdgeIndex e) const {
+		return m_weights[e];
+	}
+	/** raw arrays, offsets arrays hold num_vertices()+1 entries */
+	const EdgeIndex* offsets() const {
+		return m_offsets;
+	}
+	const Vertex* targets() const {
+		return m_targets;
+	}
+	const Weight* weights() const {
+		return m_weights;
+	}
+	const EdgeIndex* rev_offsets() const {
+		return m_rev_offsets;
+	}
+	const Vertex* rev_sources() const {
+		return m_rev_sources;
+	}
+	const EdgeIndex* rev_edges() const {
+		return m_rev_edges;
+	}
+
+	std::pair<out_edge_iterator,out_edge_iterator> out_edges(Vertex u) const {
+		return std::make_pair(out_edge_iterator(u, m_offsets[u], m_targets),
+		                      out_edge_iterator(u, m_offsets[u+1], m_targets));
+	}
+	std::pair<in_edge_iterator,in_edge_iterator> in_edges(Vertex v) const {
+		return std::make_pair(in_edge_iterator(v, m_rev_offsets[v], m_rev_sources, m_rev_edges),
+		                      in_edge_iterator(v, m_rev_offsets[v+1], m_rev_sources, m_rev_edges));
+	}
+	std::size_t out_degree(Vertex u) const {
+		return m_offsets[u+1]-m_offsets[u];
+	}
+	std::size_t in_degree(Vertex v) const {
+		return m_rev_offsets[v+1]-m_rev_offsets[v];
+	}
+
+private:
+	template <class T>
+	static const T* data_or_null(const std::vector<T>& v) {
+		return v.empty() ? 0 : &v[0];
+	}
+	bool owns_storage() const {
+		return m_offsets == data_or_null(m_s_offsets);
+	}
+	void point_to_storage() {
+		m_offsets = data_or_null(m_s_offsets);
+		m_targets = data_or_null(m_s_targets);
+		m_weights = data_or_null(m_s_weights);
+		m_rev_offsets = data_or_null(m_s_rev_offsets);
+		m_rev_sources = data_or_null(m_s_rev_sources);
+		m_rev_edges = data_or_null(m_s_rev_edges);
+	}
+
+	std::size_t m_n, m_m;
+	const EdgeIndex* m_offsets;
+	const Vertex* m_targets;
+	const Weight* m_weights;
+	const EdgeIndex* m_rev_offsets;
+	const Vertex* m_rev_sources;
+	const EdgeIndex* m_rev_edges;
+	/** storage when built by assign, empty when attached */
+	std::vector<EdgeIndex> m_s_offsets;
+	std::vector<Vertex> m_s_targets;
+	std::vector<Weight> m_s_weights;
+	std::vector<EdgeIndex> m_s_rev_offsets;
+	std::vector<Vertex> m_s_rev_sources;
+	std::vector<EdgeIndex> m_s_rev_edges;
+};
+
+/* BGL free function interface */
+
+#define TWAY_CSR_TEMPLATE template <class V, class W, class E>
+#define TWAY_CSR_GRAPH tway_csr_graph<V,W,E>
+
+TWAY_CSR_TEMPLATE
+inline V source(const typename TWAY_CSR_GRAPH::edge_descriptor& e, const TWAY_CSR_GRAPH&) {
+	return e.src;
+}
+TWAY_CSR_TEMPLATE
+inline V target(const typename TWAY_CSR_GRAPH::edge_descriptor& e, const TWAY_CSR_GRAPH&) {
+	return e.trg;
+}
+TWAY_CSR_TEMPLATE
+inline std::pair<typename TWAY_CSR_GRAPH::out_edge_iterator, typename TWAY_CSR_GRAPH::out_edge_iterator>
+out_edges(typename TWAY_CSR_GRAPH::vertex_descriptor u, const TWAY_CSR_GRAPH& g) {
+	return g.out_edges(u);
+}
+TWAY_CSR_TEMPLATE
+inline std::pair<typename TWAY_CSR_GRAPH::in_edge_iterator, typename TWAY_CSR_GRAPH::in_edge_iterator>
+in_edges(typename TWAY_CSR_GRAPH::vertex_descriptor v, const TWAY_CSR_GRAPH& g) {
+	return g.in_edges(v);
+}
+TWAY_CSR_TEMPLATE
+inline std::size_t out_degree(typename TWAY_CSR_GRAPH::vertex_descriptor u, const TWAY_CSR_GRAPH& g) {
+	return g.out_degree(u);
+}
+TWAY_CSR_TEMPLATE
+inline std::size_t in_degree(typename TWAY_CSR_GRAPH::vertex_descriptor v, const TWAY_CSR_GRAPH& g) {
+	return g.in_degree(v);
+}
+TWAY_CSR_TEMPLATE
+inline std::size_t degree(typename TWAY_CSR_GRAPH::vertex_descriptor v, const TWAY_CSR_GRAPH& g) {
+	return g.in_degree(v) + g.out_degree(v);
+}
+TWAY_CSR_TEMPLATE
+inline std::pair<typename TWAY_CSR_GRAPH::vertex_iterator, typename TWAY_CSR_GRAPH::vertex_iterator>
+vertices(const TWAY_CSR_GRAPH& g) {
+	typedef typename TWAY_CSR_GRAPH::vertex_iterator vertex_iterator;
+	return std::make_pair(vertex_iterator(0), vertex_iterator((V)g.num_vertices()));
+}
+TWAY_CSR_TEMPLATE
+inline std::size_t num_vertices(const TWAY_CSR_GRAPH& g) {
+	return g.num_vertices();
+}
+TWAY_CSR_TEMPLATE
+inline std::size_t num_edges(const TWAY_CSR_GRAPH& g) {
+	return g.num_edges();
+}
+TWAY_CSR_TEMPLATE
+inline V vertex(std::size_t i, const TWAY_CSR_GRAPH&) {
+	return (V)i;
+}
+TWAY_CSR_TEMPLATE
+inline typed_identity_property_map<V> get(vertex_index_t, const TWAY_CSR_GRAPH&) {
+	return typed_identity_property_map<V>();
+}
+TWAY_CSR_TEMPLATE
+inline typename TWAY_CSR_GRAPH::weight_map_type get(edge_weight_t, const TWAY_CSR_GRAPH& g) {
+	return g.weight_map();
+}
+
+TWAY_CSR_TEMPLATE
+struct property_map<TWAY_CSR_GRAPH, vertex_index_t> {
+	typedef typed_identity_property_map<V> type;
+	typedef type const_type;
+};
+TWAY_CSR_TEMPLATE
+struct property_map<TWAY_CSR_GRAPH, edge_weight_t> {
+	typedef typename TWAY_CSR_GRAPH::weight_map_type type;
+	typedef type const_type;
+};
+
+#undef TWAY_CSR_GRAPH
+#undef TWAY_CSR_TEMPLATE
+
+} // namespace boost
+
+#endif // BOOST_GRAPH_TWAY_CSR_GRAPH_HPP
@@ -0,0 +1,375 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+
+// updatable priority queues for tway algos
+
+#ifndef BOOST_GRAPH_TWAY_QUEUE_HPP
+#define BOOST_GRAPH_TWAY_QUEUE_HPP
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstddef>
+#include <boost/property_map/property_map.hpp>
+#include <boost/graph/tway_color.hpp>
+
+namespace boost {
+
+/**
+ * tway_dary_heap: Arity-ary min heap on get(key,v) with decrease key.
+ *   The element storage and the position of each element (index_in_heap)
+ *   are owned by the caller, so a heap over a tway_search_workspace needs
+ *   no allocation per query. Storage starts with Arity-1 unused slots so
+ *   the children of a node share one aligned group, with Arity 4 and 32 bit
+ *   vertices all siblings come in with a single cache line.
+ */
+template <class Value, std::size_t Arity, class KeyMap, class IndexInHeapMap,
+         class Compare = std::less<typename property_traits<KeyMap>::value_type>,
+         class Container = std::vector<Value> >
+class tway_dary_heap {
+public:
+	typedef Value value_type;
+	typedef Container storage_type;
+	typedef typename Container::size_type size_type;
+	typedef typename property_traits<KeyMap>::value_type key_type;
+
+	tway_dary_heap(Container& data, KeyMap key, IndexInHeapMap index,
+	               const Compare& compare = Compare())
+		: m_data(data), m_key(key), m_index(index), m_compare(compare) {
+		m_data.resize(Arity-1);
+	}
+	/** storage: the workspace container this heap type runs on */
+	template <class Workspace>
+	static Container& storage(Workspace& w, std::size_t side=0) {
+		return w.heap_storage(side);
+	}
+
+	bool empty() const {
+		return m_data.size() == Arity-1;
+	}
+	size_type size() const {
+		return m_data.size() - (Arity-1);
+	}
+	value_type& top() {
+		return m_data[Arity-1];
+	}
+	const value_type& top() const {
+		return m_data[Arity-1];
+	}
+	void push(const value_type& v) {
+		m_data.push_back(v);
+		sift_up(size()-1);
+	}
+	void pop() {
+		if (size()==1) {
+			m_data.pop_back();
+			return;
+		}
+		at(0) = m_data.back();
+		m_data.pop_back();
+		sift_down(0);
+	}
+	/** update: key of v has decreased */
+	void update(const value_type& v) {
+		sift_up(get(m_index, v));
+	}
+	void clear() {
+		m_data.resize(Arity-1);
+	}
+
+private:
+	value_type& at(size_type i) {
+		return m_data[i+Arity-1];
+	}
+	void sift_up(size_type i) {
+		value_type moving = at(i);
+		key_type moving_key = get(m_key, moving);
+		while (i>0) {
+			size_type parent = (i-1)/Arity;
+			if (!m_compare(moving_key, get(m_key, at(parent)))) break;
+			at(i) = at(parent);
+			put(m_index, at(i), i);
+			i = parent;
+		}
+		at(i) = moving;
+		put(m_index, moving, i);
+	}
+	void sift_down(size_type i) {
+		size_type n = size();
+		value_type moving = at(i);
+		key_type moving_key = get(m_key, moving);
+		for (;;) {
+			size_type first = Arity*i+1;
+			if (first>=n) break;
+			size_type last = (first+Arity < n) ? first+Arity : n;
+			size_type child = first;
+			key_type child_key = get(m_key, at(first));
+			for (size_type c=first+1; c<last; ++c) {
+				key_type c_key = get(m_key, at(c));
+				if (m_compare(c_key, child_key)) {
+					child = c;
+					child_key = c_key;
+				}
+			}
+			if (!m_compare(child_key, moving_key)) break;
+			at(i) = at(child);
+			put(m_index, at(i), i);
+			i = child;
+		}
+		at(i) = moving;
+		put(m_index, moving, i);
+	}
+
+	Container& m_data;
+	KeyMap m_key;
+	IndexInHeapMap m_index;
+	Compare m_compare;
+};
+
+/**
+ * tway_indexed_heap: binary min heap on get(key,v) with decrease key
+ */
+template <class Value, class KeyMap, class IndexInHeapMap,
+         class Compare = std::less<typename property_traits<KeyMap>::value_type>,
+         class Container = std::vector<Value> >
+class tway_indexed_heap : public tway_dary_heap<Value, 2, KeyMap, IndexInHeapMap, Compare, Container> {
+public:
+	typedef tway_dary_heap<Value, 2, KeyMap, IndexInHeapMap, Compare, Container> base_type;
+	tway_indexed_heap(Container& data, KeyMap key, IndexInHeapMap index,
+	                  const Compare& compare = Compare())
+		: base_type(data, key, index, compare) {}
+};
+
+/**
+ * tway_radix_heap: radix heap on unsigned integer keys with decrease key.
+ *   Bucket b>0 holds keys whose highest bit differing from the last popped
+ *   key is bit b-1, bucket 0 holds keys equal to it. Pop only rescans a
+ *   bucket when bucket 0 runs dry, so push and update are O(1) and pop is
+ *   amortized O(bits) while keys never drop below the last popped one, as
+ *   with dijkstra or consistent heuristics. A smaller key still comes out
+ *   in order, it is kept in bucket 0 which is then searched for its min.
+ *   Compare is accepted for interface parity, the order is always less.
+ */
+template <class Value, class KeyMap, class IndexInHeapMap,
+         class Compare = std::less<typename property_traits<KeyMap>::value_type>,
+         class Container = std::vector<std::vector<Value> > >
+class tway_radix_heap {
+public:
+	typedef Value value_type;
+	typedef Container storage_type;
+	typedef typename Container::value_type bucket_type;
+	typedef typename bucket_type::size_type size_type;
+	typedef typename property_traits<KeyMap>::value_type key_type;
+	enum { buckets = sizeof(key_type)*8 + 1 };
+
+	tway_radix_heap(Container& data, KeyMap key, IndexInHeapMap index,
+	                const Compare& = Compare())
+		: m_b(data), m_key(key), m_index(index), m_size(0), m_last(0), m_low(false) {
+		m_b.resize(buckets);
+		for (size_type i=0; i<buckets; ++i)
+			m_b[i].clear();
+	}
+	/** storage: the workspace container this heap type runs on */
+	template <class Workspace>
+	static Container& storage(Workspace& w, std::size_t side=0) {
+		return w.bucket_storage(side);
+	}
+
+	bool empty() const {
+		return m_size == 0;
+	}
+	size_type size() const {
+		return m_size;
+	}
+	value_type& top() {
+		settle();
+		return m_b[0].back();
+	}
+	void push(const value_type& v) {
+		place(v, bucket(get(m_key, v)));
+		++m_size;
+	}
+	void pop() {
+		settle();
+		m_b[0].pop_back();
+		if (m_b[0].empty()) m_low = false;
+		--m_size;
+	}
+	/** update: key of v has decreased */
+	void update(const value_type& v) {
+		size_type at = get(m_index, v);
+		size_type from = at % buckets;
+		size_type to = bucket(get(m_key, v));
+		if (to == from) return;
+		remove(from, at / buckets);
+		place(v, to);
+	}
+	void clear() {
+		for (size_type i=0; i<buckets; ++i)
+			m_b[i].clear();
+		m_size = 0;
+		m_low = false;
+	}
+
+private:
+	size_type bucket(key_type k) {
+		if (k <= m_last) {
+			if (k < m_last) m_low = true;
+			return 0;
+		}
+		unsigned long long x = (unsigned long long)(k ^ m_last);
+#ifdef __GNUC__
+		return 64 - __builtin_clzll(x);
+#else
+		size_type b = 0;
+		while (x) {
+			x >>= 1;
+			++b;
+		}
+		return b;
+#endif
+	}
+	void place(const value_type& v, size_type b) {
+		put(m_index, v, m_b[b].size()*buckets + b);
+		m_b[b].push_back(v);
+	}
+	void remove(size_type b, size_type pos) {
+		bucket_type& bk = m_b[b];
+		if (pos+1 != bk.size()) {
+			bk[pos] = bk.back();
+			put(m_index, bk[pos], pos*buckets + b);
+		}
+		bk.pop_back();
+	}
+	/** settle: minimum moved to the back of bucket 0 */
+	void settle() {
+		if (m_b[0].empty()) {
+			size_type i = 1;
+			while (m_b[i].empty()) ++i;
+			bucket_type& bk = m_b[i];
+			key_type low = get(m_key, bk[0]);
+			for (size_type j=1; j<bk.size(); ++j)
+				if (get(m_key, bk[j]) < low) low = get(m_key, bk[j]);
+			m_last = low;
+			bucket_type moving;
+			moving.swap(bk);
+			for (size_type j=0; j<moving.size(); ++j)
+				place(moving[j], bucket(get(m_key, moving[j])));
+			moving.clear();
+			moving.swap(bk);
+		}
+		if (m_low) {
+			bucket_type& bk = m_b[0];
+			size_type best = bk.size()-1;
+			for (size_type j=0; j+1<bk.size(); ++j)
+				if (get(m_key, bk[j]) < get(m_key, bk[best])) best = j;
+			if (best+1 != bk.size()) {
+				std::swap(bk[best], bk.back());
+				put(m_index, bk[best], best*buckets);
+				put(m_index, bk.back(), (bk.size()-1)*buckets);
+			}
+		}
+	}
+
+	Container& m_b;
+	KeyMap m_key;
+	IndexInHeapMap m_index;
+	size_type m_size;
+	key_type m_last;
+	bool m_low;
+};
+
+/** tway_balance_policy: side a tway_balanced_queue expands next */
+enum tway_balance_policy { TWAY_BALANCE_ALTERNATE, TWAY_BALANCE_SIZE, TWAY_BALANCE_KEY };
+
+/**
+ * tway_balanced_queue: forward and backward queues of a two way search kept
+ *   apart, a vertex goes to the queue of its color (silver forward, gold
+ *   backward). top picks the side by policy, strict alternation, smaller
+ *   queue or smaller min key, and a side that ran dry is never picked.
+ *   The pick holds until pop, so it drops in for the shared queue of
+ *   tway_breadth_first_visit and the astar visitor.
+ */
+template <class Queue, class KeyMap, class ColorMap>
+class tway_balanced_queue {
+public:
+	typedef typename Queue::value_type value_type;
+	typedef typename Queue::size_type size_type;
+	typedef typename property_traits<ColorMap>::value_type color_type;
+
+	tway_balanced_queue(const Queue& fwd, const Queue& rev, KeyMap key, ColorMap color,
+	                    tway_balance_policy policy)
+		: m_fwd(fwd), m_rev(rev), m_key(key), m_color(color), m_policy(policy),
+		  m_side(1), m_picked(false) {}
+
+	bool empty() {
+		return side(0).empty() && side(1).empty();
+	}
+	size_type size() {
+		return side(0).size() + side(1).size();
+	}
+	value_type& top() {
+		return side(pick()).top();
+	}
+	void pop() {
+		side(pick()).pop();
+		m_picked = false;
+	}
+	void push(const value_type& v) {
+		side(of(v)).push(v);
+	}
+	/** update: key of v has decreased */
+	void update(const value_type& v) {
+		side(of(v)).update(v);
+	}
+	void clear() {
+		side(0).clear();
+		side(1).clear();
+		m_picked = false;
+	}
+
+private:
+	Queue& side(std::size_t i) {
+		return (i) ? m_rev : m_fwd;
+	}
+	std::size_t of(const value_type& v) {
+		return (get(m_color, v) == color_traits<color_type>::silver()) ? 0 : 1;
+	}
+	std::size_t pick() {
+		if (m_picked) return m_side;
+		m_picked = true;
+		if (side(0).empty()) return m_side = 1;
+		if (side(1).empty()) return m_side = 0;
+		switch (m_policy) {
+		case TWAY_BALANCE_ALTERNATE:
+			m_side = 1 - m_side;
+			break;
+		case TWAY_BALANCE_SIZE:
+			m_side = (side(1).size() < side(0).size()) ? 1 : 0;
+			break;
+		default:
+			m_side = (get(m_key, side(1).top()) < get(m_key, side(0).top())) ? 1 : 0;
+			break;
+		}
+		return m_side;
+	}
+
+	Queue m_fwd;
+	Queue m_rev;
+	KeyMap m_key;
+	ColorMap m_color;
+	tway_balance_policy m_policy;
+	std::size_t m_side;
+	bool m_picked;
+};
+
+} // namespace boost
+
+#endif // BOOST_GRAPH_TWAY_QUEUE_HPP
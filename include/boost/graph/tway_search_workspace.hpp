@@ -0,0 +1,185 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+
+// reusable per thread search state for tway algos
+
+#ifndef BOOST_GRAPH_TWAY_SEARCH_WORKSPACE_HPP
+#define BOOST_GRAPH_TWAY_SEARCH_WORKSPACE_HPP
+
+#include <vector>
+#include <limits>
+#include <boost/property_map/property_map.hpp>
+#include <boost/graph/properties.hpp>
+#include <stdint.h>
+
+namespace boost {
+
+/**
+ * tway_search_workspace: search state allocated once and reused per query.
+ *   Every vertex record carries the epoch it was last written in. A record
+ *   stamped with an older epoch reads as freshly initialized, so starting
+ *   a search costs O(1) and the query only pays for the vertices it touches.
+ *   One workspace must not be shared by two concurrent searches.
+ */
+template <class Vertex, class Distance, class ColorValue>
+class tway_search_workspace {
+public:
+	typedef Vertex vertex_type;
+	typedef Distance distance_type;
+	typedef ColorValue color_type;
+	typedef std::size_t size_type;
+	typedef std::vector<Vertex> heap_storage_type;
+	typedef std::vector<std::vector<Vertex> > bucket_storage_type;
+
+	/** record: all per vertex fields together, one cache line fetch per touch;
+	 *  side 0 holds the labels of a one way or forward search, side 1 the
+	 *  backward labels of a best meeting search, so both can label a vertex */
+	struct record {
+		uint32_t stamp;
+		Distance distance[2];
+		Distance cost[2];
+		Vertex predecessor[2];
+		size_type index_in_heap[2];
+		ColorValue color[2];
+	};
+
+	/** stats_type: per search counters, cleared by reset, forward counts
+	 *  the settled vertices of the forward side of a two way search */
+	struct stats_type {
+		stats_type() : touched(0), settled(0), forward(0) {}
+		size_type touched;
+		size_type settled;
+		size_type forward;
+	};
+
+	/**
+	 * field_map: read write property map over one side of a record field
+	 */
+	template <class Value, Value (record::*Member)[2]>
+	struct field_map {
+		typedef Vertex key_type;
+		typedef Value value_type;
+		typedef Value reference;
+		typedef read_write_property_map_tag category;
+		field_map() : m_ws(0), m_side(0) {}
+		field_map(tway_search_workspace* ws, size_type side) : m_ws(ws), m_side(side) {}
+		friend inline Value get(const field_map& pm, Vertex v) {
+			return (pm.m_ws->touch(v).*Member)[pm.m_side];
+		}
+		friend inline void put(const field_map& pm, Vertex v, const Value& val) {
+			(pm.m_ws->touch(v).*Member)[pm.m_side] = val;
+		}
+	private:
+		tway_search_workspace* m_ws;
+		size_type m_side;
+	};
+	typedef field_map<Distance, &record::distance> distance_map_type;
+	typedef field_map<Distance, &record::cost> cost_map_type;
+	typedef field_map<Vertex, &record::predecessor> predecessor_map_type;
+	typedef field_map<size_type, &record::index_in_heap> index_in_heap_map_type;
+	typedef field_map<ColorValue, &record::color> color_map_type;
+
+	tway_search_workspace()
+		: m_epoch(0), m_inf((std::numeric_limits<Distance>::max)()) {}
+	~tway_search_workspace() {}
+
+	/**
+	 * reset: start a new search over n vertices, O(1) unless n changed
+	 *        or the epoch counter wrapped around
+	 */
+	void reset(size_type n, Distance inf) {
+		m_inf = inf;
+		m_heap[0].clear();
+		m_heap[1].clear();
+		m_stats = stats_type();
+		if (n != m_rec.size()) {
+			m_rec.assign(n, record());
+			m_epoch = 1;
+			return;
+		}
+		if (++m_epoch == 0) {
+			for (size_type i=0; i<m_rec.size(); ++i)
+				m_rec[i].stamp = 0;
+			m_epoch = 1;
+		}
+	}
+	/**
+	 * touch: record of v, initialized on first access in this epoch
+	 */
+	inline record& touch(Vertex v) {
+		record& r = m_rec[v];
+		if (r.stamp != m_epoch) {
+			++m_stats.touched;
+			r.stamp = m_epoch;
+			r.distance[0] = r.distance[1] = m_inf;
+			r.cost[0] = r.cost[1] = m_inf;
+			r.predecessor[0] = r.predecessor[1] = v;
+			r.index_in_heap[0] = r.index_in_heap[1] = 0;
+			r.color[0] = r.color[1] = color_traits<ColorValue>::white();
+		}
+		return r;
+	}
+	/**
+	 * visited: true if v was touched by the current search
+	 */
+	inline bool visited(Vertex v) const {
+		return m_rec[v].stamp == m_epoch;
+	}
+	size_type size() const {
+		return m_rec.size();
+	}
+
+	/** distance_map ... color_map: labels of side 0 unless side 1 is asked */
+	distance_map_type distance_map(size_type side=0) {
+		return distance_map_type(this, side);
+	}
+	cost_map_type cost_map(size_type side=0) {
+		return cost_map_type(this, side);
+	}
+	predecessor_map_type predecessor_map(size_type side=0) {
+		return predecessor_map_type(this, side);
+	}
+	index_in_heap_map_type index_in_heap_map(size_type side=0) {
+		return index_in_heap_map_type(this, side);
+	}
+	color_map_type color_map(size_type side=0) {
+		return color_map_type(this, side);
+	}
+	/** heap_storage: side 0 for a shared or forward queue, 1 backward */
+	heap_storage_type& heap_storage(size_type side=0) {
+		return m_heap[side];
+	}
+	/** bucket_storage: kept for bucketed queues, each queue clears it */
+	bucket_storage_type& bucket_storage(size_type side=0) {
+		return m_buckets[side];
+	}
+	/**
+	 * stats: counters of the current search, searches bump settled from
+	 *        their visitors, touched counts records initialized
+	 */
+	stats_type& stats() {
+		return m_stats;
+	}
+	const stats_type& stats() const {
+		return m_stats;
+	}
+
+private:
+	std::vector<record> m_rec;
+	heap_storage_type m_heap[2];
+	bucket_storage_type m_buckets[2];
+	uint32_t m_epoch;
+	stats_type m_stats;
+	Distance m_inf;
+};
+
+} // namespace boost
+
+#endif // BOOST_GRAPH_TWAY_SEARCH_WORKSPACE_HPP
@@ -0,0 +1,242 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_ALTERNATIVES_HPP_
+#define _TESTASTAR_ALTERNATIVES_HPP_
+#include "Locals.hh"
+#include "Potentials.hpp"
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <stdint.h>
+#include <boost/graph/tway_csr_graph.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/tway_queue.hpp>
+
+namespace TestAstar {
+
+/**
+ * AlternativeLimits: admissible alternatives as fractions of the optimal
+ *   cost D, at most (1 + stretch) D long, sharing at most share D with the
+ *   routes taken before, every subpath up to local D around the via vertex
+ *   a shortest path; tries bounds the candidates kept per route asked
+ */
+struct AlternativeLimits {
+	AlternativeLimits() : stretch(0.25), share(0.8), local(0.25), tries(4) {}
+	double stretch;
+	double share;
+	double local;
+	size_t tries;
+};
+
+/**
+ * AlternativeRoutes: alternatives from the two trees of one best meeting
+ *   search.
+ *
+ * The search runs on past the optimum until its keys reach (1 + stretch) D
+ * and the visitor hands over every vertex it settles. Each one labelled by
+ * both sides is a via candidate: the forward tree path s..v and the
+ * backward tree path v..t, of cost d_f(v) + d_b(v), kept if it is simple.
+ * Candidates are taken cheapest first while they share little with the
+ * routes kept so far, then checked for local optimality by one small
+ * search each between the points local D before and after v on the route,
+ * so the cost stays a small multiple of a single query.
+ */
+class AlternativeRoutes {
+public:
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef std::vector<U_INT> PathT;
+
+	AlternativeRoutes(const AlternativeLimits& limits) : hLimits(limits) {}
+	~AlternativeRoutes() {}
+
+	/** Stretch: how far past the optimum the search has to run */
+	double Stretch() const {
+		return hLimits.stretch;
+	}
+	/** Add: a vertex settled by the search */
+	inline void Add(VertexT v) {
+		hVia.push_back(v);
+	}
+	/**
+	 * Select: best, the shortest path of cost, then up to k-1 alternatives
+	 *         into paths and costs; reads the trees left in Work, which
+	 *         the local checks then reuse, returns how many
+	 */
+	template <typename WorkspaceType>
+	size_t Select(const GraphT& g, const Potentials& pot, const PathT& best, U_INT cost, size_t k,
+	              std::vector<PathT>& paths, std::vector<U_INT>& costs, WorkspaceType& Work) {
+		paths.assign(1, best);
+		costs.assign(1, cost);
+		if (k <= 1 || best.size() < 2) return 1;
+		typename WorkspaceType::stats_type stats = Work.stats();
+		std::vector<candidate> cand;
+		Candidates(g, cost, cand, Work);
+		std::set<std::pair<U_INT, U_INT> > used;
+		Use(best, used);
+		std::vector<route> pending;
+		U_INT shared_max = (U_INT)(cost * hLimits.share);
+		for (size_t i=0; i<cand.size() && pending.size() < (k-1) * hLimits.tries; ++i) {
+			route r;
+			if (!Extract(cand[i], r, Work)) continue;
+			if (Shared(r, used) > shared_max) continue;
+			Use(r.path, used);
+			pending.push_back(r);
+		}
+		U_INT local = (U_INT)(cost * hLimits.local);
+		for (size_t i=0; i<pending.size() && paths.size() < k; ++i) {
+			if (!LocallyOptimal(g, pot, pending[i], local, Work, stats.settled)) continue;
+			paths.push_back(PathT());
+			paths.back().swap(pending[i].path);
+			costs.push_back(pending[i].cost);
+		}
+		Work.stats() = stats;
+		return paths.size();
+	}
+private:
+	/** candidate: via vertex v and the cost of the route through it */
+	struct candidate {
+		U_INT cost;
+		VertexT v;
+		bool operator<(const candidate& o) const {
+			return (cost != o.cost) ? cost < o.cost : v < o.v;
+		}
+	};
+	/** route: vertices, distance from s at each, via vertex position */
+	struct route {
+		PathT path;
+		std::vector<U_INT> pos;
+		size_t via;
+		U_INT cost;
+	};
+	/**
+	 * Candidates: the distinct via vertices within the stretch, cheapest
+	 *             first, costs over the final labels of both sides
+	 */
+	template <typename WorkspaceType>
+	void Candidates(const GraphT& g, U_INT cost, std::vector<candidate>& cand, WorkspaceType& Work) {
+		typename WorkspaceType::distance_map_type d_f = Work.distance_map(), d_b = Work.distance_map(1);
+		std::sort(hVia.begin(), hVia.end());
+		hVia.erase(std::unique(hVia.begin(), hVia.end()), hVia.end());
+		uint64_t limit = cost + (uint64_t)(cost * hLimits.stretch);
+		for (size_t i=0; i<hVia.size(); ++i) {
+			uint64_t c = (uint64_t)get(d_f, hVia[i]) + get(d_b, hVia[i]);
+			if (c > limit) continue;
+			candidate x;
+			x.cost = (U_INT)c;
+			x.v = hVia[i];
+			cand.push_back(x);
+		}
+		std::sort(cand.begin(), cand.end());
+	}
+	/**
+	 * Extract: the route through a via vertex from the predecessors of
+	 *          both sides, the backward distances count down to t; false
+	 *          if it visits a vertex twice
+	 */
+	template <typename WorkspaceType>
+	bool Extract(const candidate& c, route& r, WorkspaceType& Work) {
+		typename WorkspaceType::predecessor_map_type p_f = Work.predecessor_map(), p_b = Work.predecessor_map(1);
+		typename WorkspaceType::distance_map_type d_f = Work.distance_map(), d_b = Work.distance_map(1);
+		size_t max = Work.size();
+		for (VertexT v=c.v; ; v=get(p_f, v)) {
+			r.path.push_back(v);
+			r.pos.push_back(get(d_f, v));
+			if (v == get(p_f, v)) break;
+			if (!max--) return false;
+		}
+		std::reverse(r.path.begin(), r.path.end());
+		std::reverse(r.pos.begin(), r.pos.end());
+		r.via = r.path.size() - 1;
+		for (VertexT v=c.v; v != get(p_b, v); ) {
+			v = get(p_b, v);
+			r.path.push_back(v);
+			r.pos.push_back(c.cost - get(d_b, v));
+			if (!max--) return false;
+		}
+		r.cost = c.cost;
+		PathT sorted(r.path);
+		std::sort(sorted.begin(), sorted.end());
+		return std::adjacent_find(sorted.begin(), sorted.end()) == sorted.end();
+	}
+	/** Shared: cost of the route edges already on a kept route */
+	static U_INT Shared(const route& r, const std::set<std::pair<U_INT, U_INT> >& used) {
+		U_INT shared = 0;
+		for (size_t i=1; i<r.path.size(); ++i)
+			if (used.count(std::make_pair(r.path[i-1], r.path[i])))
+				shared += r.pos[i] - r.pos[i-1];
+		return shared;
+	}
+	static void Use(const PathT& path, std::set<std::pair<U_INT, U_INT> >& used) {
+		for (size_t i=1; i<path.size(); ++i)
+			used.insert(std::make_pair(path[i-1], path[i]));
+	}
+	/**
+	 * LocallyOptimal: x at least local before the via vertex and y at least
+	 *                 local after it, true if no path x..y is shorter than
+	 *                 the route's; an astar on the coordinate bound that
+	 *                 gives up once its keys reach that length
+	 */
+	template <typename WorkspaceType>
+	bool LocallyOptimal(const GraphT& g, const Potentials& pot, const route& r, U_INT local,
+	                    WorkspaceType& Work, size_t& settled) {
+		typedef boost::tway_dary_heap<VertexT, 4, typename WorkspaceType::cost_map_type,
+		        typename WorkspaceType::index_in_heap_map_type> QueueT;
+		typedef boost::color_traits<typename WorkspaceType::color_type> Color;
+		size_t i = r.via, j = r.via;
+		while (i > 0 && r.pos[r.via] - r.pos[i] < local) --i;
+		while (j + 1 < r.path.size() && r.pos[j] - r.pos[r.via] < local) ++j;
+		VertexT x = r.path[i], y = r.path[j];
+		U_INT len = r.pos[j] - r.pos[i];
+		Work.reset(num_vertices(g), std::numeric_limits<U_INT>::max());
+		typename WorkspaceType::distance_map_type d = Work.distance_map();
+		typename WorkspaceType::cost_map_type key = Work.cost_map();
+		typename WorkspaceType::color_map_type color = Work.color_map();
+		QueueT Q(Work.heap_storage(), key, Work.index_in_heap_map());
+		put(d, x, 0);
+		put(key, x, pot.Bound(x, y));
+		put(color, x, Color::gray());
+		Q.push(x);
+		bool shorter = false;
+		while (!Q.empty() && get(key, Q.top()) < len) {
+			VertexT u = Q.top();
+			Q.pop();
+			++settled;
+			if (u == y) {
+				shorter = true;
+				break;
+			}
+			put(color, u, Color::black());
+			U_INT du = get(d, u);
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				VertexT v = target(*ei, g);
+				U_INT dv = du + get(g.weight_map(), *ei);
+				if (get(color, v) == Color::black() || dv >= get(d, v)) continue;
+				put(d, v, dv);
+				put(key, v, dv + pot.Bound(v, y));
+				if (get(color, v) == Color::white()) {
+					put(color, v, Color::gray());
+					Q.push(v);
+				} else {
+					Q.update(v);
+				}
+			}
+		}
+		return !shorter;
+	}
+
+	AlternativeLimits hLimits;
+	std::vector<VertexT> hVia;
+};
+} // namespace TestAstar
+#endif
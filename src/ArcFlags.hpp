@@ -0,0 +1,247 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_ARC_FLAGS_HPP_
+#define _TESTASTAR_ARC_FLAGS_HPP_
+#include "Locals.hh"
+#include "OneToAll.hpp"
+#include "SearchOptions.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+#include <stdint.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/graph/tway_csr_graph.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+
+namespace TestAstar {
+
+/**
+ * ArcFlags: regions from the coordinates and one flag per arc and region,
+ *   set when the arc starts a shortest path into the region.
+ *
+ * Flags are region major, row r holds one bit per forward edge index for
+ * region r, a forward row for paths into r and a backward row for paths out
+ * of it. A query reads the forward row of the target region and the backward
+ * row of the source region only. Rows are filled by one backward (forward)
+ * Dijkstra per entry (exit) vertex of the region, each thread owns whole
+ * regions so it writes its own rows.
+ */
+class ArcFlags {
+public:
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef boost::tway_search_workspace<VertexT, U_INT, boost::tway_color_type> WorkspaceT;
+
+	ArcFlags() : hCount(0), hWords(0), hGraph(0) {}
+	~ArcFlags() {}
+
+	/**
+	 * Build: split the vertices into count regions by coordinates and flag
+	 *        the arcs on threads, 0 threads is one per core
+	 */
+	template <typename NodeType>
+	void Build(const GraphT& g, const NodeType* coords, size_t count, partition_kind kind, size_t threads) {
+		if (!coords) throw local_exception("Arc flags need coordinates");
+		size_t n = num_vertices(g);
+		hCount = 0;
+		hRegion.assign(n, 0);
+		if (!n || !count) return;
+		if (kind == PARTITION_GRID) Grid(coords, n, count);
+		else {
+			std::vector<VertexT> ids(n);
+			for (size_t v=0; v<n; ++v) ids[v] = v;
+			hCount = std::min(count, n);
+			Kd(coords, &ids[0], &ids[0]+n, 0, hCount);
+		}
+		hMembers.resize(n);
+		hStart.assign(hCount+1, 0);
+		for (size_t v=0; v<n; ++v) ++hStart[hRegion[v]+1];
+		for (size_t r=0; r<hCount; ++r) hStart[r+1] += hStart[r];
+		std::vector<size_t> fill(hStart.begin(), hStart.end()-1);
+		for (size_t v=0; v<n; ++v) hMembers[fill[hRegion[v]]++] = v;
+		hWords = (num_edges(g) + 31) / 32;
+		hForward.assign(hCount * hWords, 0);
+		hBackward.assign(hCount * hWords, 0);
+		if (!threads) threads = boost::thread::hardware_concurrency();
+		threads = std::max((size_t)1, std::min(threads, hCount));
+		hGraph = &g;
+		boost::thread_group pool;
+		for (size_t i=1; i<threads; ++i)
+			pool.create_thread(boost::bind(&ArcFlags::Worker, this, i, threads));
+		Worker(0, threads);
+		pool.join_all();
+		hGraph = 0;
+		std::vector<VertexT>().swap(hMembers);
+		std::vector<size_t>().swap(hStart);
+	}
+	size_t Count() const {
+		return hCount;
+	}
+	size_t Bytes() const {
+		return (hForward.size() + hBackward.size()) * sizeof(uint32_t) + hRegion.size() * sizeof(U_INT);
+	}
+	U_INT Region(VertexT v) const {
+		return hRegion[v];
+	}
+	/** Forward: flags of arcs towards region r */
+	const uint32_t* Forward(U_INT r) const {
+		return &hForward[r * hWords];
+	}
+	/** Backward: flags of arcs away from region r */
+	const uint32_t* Backward(U_INT r) const {
+		return &hBackward[r * hWords];
+	}
+private:
+	static inline void Set(uint32_t* row, size_t e) {
+		row[e >> 5] |= (uint32_t)1 << (e & 31);
+	}
+	/** AxisLess: orders vertices on one coordinate axis */
+	template <typename NodeType>
+	struct AxisLess {
+		AxisLess(const NodeType* c, bool ax) : coords(c), axis(ax) {}
+		bool operator()(VertexT a, VertexT b) const {
+			return (axis) ? coords[a].y < coords[b].y : coords[a].x < coords[b].x;
+		}
+		const NodeType* coords;
+		bool axis;
+	};
+	/**
+	 * Kd: regions first .. first+k over ids, split on the wider axis with
+	 *     vertex counts in proportion to the regions on each side
+	 */
+	template <typename NodeType>
+	void Kd(const NodeType* coords, VertexT* lo, VertexT* hi, size_t first, size_t k) {
+		if (k <= 1 || hi - lo <= 1) {
+			for (VertexT* p=lo; p<hi; ++p) hRegion[*p] = first;
+			return;
+		}
+		S_INT minx = coords[*lo].x, maxx = minx, miny = coords[*lo].y, maxy = miny;
+		for (VertexT* p=lo; p<hi; ++p) {
+			minx = std::min(minx, coords[*p].x);
+			maxx = std::max(maxx, coords[*p].x);
+			miny = std::min(miny, coords[*p].y);
+			maxy = std::max(maxy, coords[*p].y);
+		}
+		bool axis = ((double)maxy - miny) > ((double)maxx - minx);
+		size_t left = k / 2;
+		VertexT* mid = lo + (size_t)((hi - lo) * (uint64_t)left / k);
+		std::nth_element(lo, mid, hi, AxisLess<NodeType>(coords, axis));
+		Kd(coords, lo, mid, first, left);
+		Kd(coords, mid, hi, first + left, k - left);
+	}
+	/**
+	 * Grid: cols by rows cells over the bounding box, cols the root of
+	 *       count, so up to cols-1 fewer regions than asked
+	 */
+	template <typename NodeType>
+	void Grid(const NodeType* coords, size_t n, size_t count) {
+		size_t cols = std::max((size_t)1, (size_t)std::sqrt((double)count));
+		size_t rows = std::max((size_t)1, count / cols);
+		S_INT minx = coords[0].x, maxx = minx, miny = coords[0].y, maxy = miny;
+		for (size_t v=0; v<n; ++v) {
+			minx = std::min(minx, coords[v].x);
+			maxx = std::max(maxx, coords[v].x);
+			miny = std::min(miny, coords[v].y);
+			maxy = std::max(maxy, coords[v].y);
+		}
+		double w = (double)maxx - minx + 1, h = (double)maxy - miny + 1;
+		for (size_t v=0; v<n; ++v) {
+			size_t c = (size_t)(((double)coords[v].x - minx) * cols / w);
+			size_t r = (size_t)(((double)coords[v].y - miny) * rows / h);
+			hRegion[v] = std::min(r, rows-1) * cols + std::min(c, cols-1);
+		}
+		hCount = cols * rows;
+	}
+	void Worker(size_t part, size_t parts) {
+		WorkspaceT Work;
+		std::vector<U_INT> dist;
+		for (size_t r=part; r<hCount; r+=parts)
+			Fill(r, dist, Work);
+	}
+	/**
+	 * Fill: both rows of region r, arcs inside r are always flagged
+	 */
+	void Fill(size_t r, std::vector<U_INT>& dist, WorkspaceT& Work) {
+		const GraphT& g = *hGraph;
+		uint32_t* fwd = &hForward[r * hWords];
+		uint32_t* bwd = &hBackward[r * hWords];
+		for (size_t i=hStart[r]; i<hStart[r+1]; ++i) {
+			VertexT u = hMembers[i];
+			bool entry = false, exit = false;
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				if (hRegion[target(*ei, g)] != r) {
+					exit = true;
+					continue;
+				}
+				Set(fwd, ei->idx);
+				Set(bwd, ei->idx);
+			}
+			GraphT::in_edge_iterator ii, ii_end;
+			for (boost::tie(ii, ii_end) = in_edges(u, g); ii != ii_end && !entry; ++ii)
+				entry = (hRegion[source(*ii, g)] != r);
+			if (entry) {
+				DijkstraOneToAll(g, u, dist, Work, true);
+				Mark(g, dist, fwd, true);
+			}
+			if (exit) {
+				DijkstraOneToAll(g, u, dist, Work, false);
+				Mark(g, dist, bwd, false);
+			}
+		}
+	}
+	/**
+	 * Mark: flag the arcs tight in dist, distances to the root when
+	 *       reverse, else from it
+	 */
+	static void Mark(const GraphT& g, const std::vector<U_INT>& dist, uint32_t* row, bool reverse) {
+		const U_INT inf = std::numeric_limits<U_INT>::max();
+		for (VertexT u=0; u<num_vertices(g); ++u) {
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				U_INT near = (reverse) ? dist[target(*ei, g)] : dist[u];
+				U_INT far = (reverse) ? dist[u] : dist[target(*ei, g)];
+				if (near != inf && far == near + get(g.weight_map(), *ei))
+					Set(row, ei->idx);
+			}
+		}
+	}
+
+	size_t hCount;
+	size_t hWords;
+	std::vector<U_INT> hRegion;
+	std::vector<uint32_t> hForward;
+	std::vector<uint32_t> hBackward;
+	std::vector<VertexT> hMembers;
+	std::vector<size_t> hStart;
+	const GraphT* hGraph;
+};
+
+/**
+ * arc_flags_filter: edge filter for the tway searches, the forward side
+ *   follows arcs flagged towards the target region, the backward side arcs
+ *   flagged away from the source region; null rows keep every edge
+ */
+struct arc_flags_filter {
+	arc_flags_filter() : m_fwd(0), m_bwd(0) {}
+	arc_flags_filter(const uint32_t* fwd, const uint32_t* bwd) : m_fwd(fwd), m_bwd(bwd) {}
+	template <class Edge>
+	bool operator()(const Edge& e, bool is_fwd) const {
+		const uint32_t* row = (is_fwd) ? m_fwd : m_bwd;
+		return !row || ((row[e.idx >> 5] >> (e.idx & 31)) & 1);
+	}
+private:
+	const uint32_t* m_fwd;
+	const uint32_t* m_bwd;
+};
+} // namespace TestAstar
+#endif
@@ -10,14 +10,29 @@
 #ifndef _TESTASTAR_ASTAR_GRAPH_HPP_
 #define _TESTASTAR_ASTAR_GRAPH_HPP_
 #include "Locals.hh"
+#include "GraphSnapshot.hpp"
+#include "SearchOptions.hpp"
+#include "Potentials.hpp"
+#include "SpatialIndex.hpp"
+#include "DistanceMatrix.hpp"
+#include "OneToAll.hpp"
+#include "Isochrone.hpp"
+#include "Renumber.hpp"
+#include "ParallelBuild.hpp"
+#include "WeightUpdates.hpp"
 #include <boost/tuple/tuple.hpp>
-#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/tway_csr_graph.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
 #include <boost/graph/astar_search.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+#include <boost/graph/tway_queue.hpp>
+#include <boost/graph/tway_breadth_first_visit.hpp>
 #include <cmath>
+#include <limits>
 
 namespace TestAstar {
 /** xNode: struct to hold node */
@@ -26,23 +41,39 @@ struct xNode {
 	S_INT x;
 	S_INT y;
 };
-/** xEdge: struct to hold edge */
-struct xEdge {
-	xEdge() : cost(0) {}
-	U_INT cost;
-};
 /** found_goal:  Exception struct throwable*/
 struct found_goal {};
 /**
- * astar_goal_visitor: Visitor for astar, right now only termination
+ * astar_goal_visitor: Visitor for astar, termination and settled count,
+ *   one directional so every settled vertex is forward too, with
+ *   throws=false the goal is left to astar_goal_stop instead
  */
 template<typename VertexType>
 struct astar_goal_visitor : public boost::default_astar_visitor {
 public:
-	astar_goal_visitor(VertexType goal) : m_goal(goal) {}
+	astar_goal_visitor(VertexType goal, std::size_t& settled, std::size_t& forward, bool throws=true)
+		: m_goal(goal), m_settled(&settled), m_forward(&forward), m_throws(throws) {}
 	template<typename GraphType>
 	void examine_vertex(VertexType u, GraphType& g) {
-		if (u == m_goal) throw found_goal();
+		++*m_settled;
+		++*m_forward;
+		if (m_throws && u == m_goal) throw found_goal();
+	}
+private:
+	VertexType m_goal;
+	std::size_t* m_settled;
+	std::size_t* m_forward;
+	bool m_throws;
+};
+/**
+ * astar_goal_stop: stop predicate, the goal is on top of the queue
+ */
+template<typename VertexType>
+struct astar_goal_stop {
+public:
+	astar_goal_stop(VertexType goal) : m_goal(goal) {}
+	bool operator()(VertexType u) const {
+		return u == m_goal;
 	}
 private:
 	VertexType m_goal;
@@ -55,89 +86,383 @@ template<typename GraphType>
 struct distance_heuristic : public boost::astar_heuristic<GraphType, U_INT> {
 public:
 	typedef typename boost::graph_traits<GraphType>::vertex_descriptor vertex_descriptor;
-	distance_heuristic(GraphType& g, vertex_descriptor goal) : m_g(g), m_goal(goal) {}
+	distance_heuristic(const xNode* nodes, vertex_descriptor goal) : m_nodes(nodes), m_goal(goal) {}
 	inline U_INT operator()(vertex_descriptor u) {
 #ifdef USE_MANHATTAN_DISTANCE
-		return (labs(m_g[m_goal].x - m_g[u].x) + labs( m_g[m_goal].y - m_g[u].y))/2;
+		return (labs(m_nodes[m_goal].x - m_nodes[u].x) + labs( m_nodes[m_goal].y - m_nodes[u].y))/2;
 #else
-		return pow(m_g[m_goal].x - m_g[u].x,2) + pow(m_g[m_goal].y - m_g[u].y,2);
+		return pow(m_nodes[m_goal].x - m_nodes[u].x,2) + pow(m_nodes[m_goal].y - m_nodes[u].y,2);
 #endif
 	}
 private:
-	GraphType& m_g;
+	const xNode* m_nodes;
 	vertex_descriptor m_goal;
 };
 
 class AstarGraph {
 
 public:
-	typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, xNode, xEdge> GraphT;
-	AstarGraph() {}
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef PotentialWorkspace<boost::tway_search_workspace<VertexT, U_INT, boost::default_color_type> > WorkspaceT;
+	typedef boost::tway_indexed_heap<VertexT, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> QueueT;
+	typedef boost::tway_dary_heap<VertexT, 4, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> Queue4T;
+	typedef boost::tway_radix_heap<VertexT, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> RadixQueueT;
+	AstarGraph() : hCoords(0), hVerts(0), hQueue(QUEUE_BINARY), hTerm(TERMINATE_FIRST),
+		hPotential(POTENTIAL_SCALED), hRenumber(RENUMBER_NONE) {}
 	~AstarGraph() {}
 	/**
-	 * AddEdge: Add Graph Edge
+	 * AddEdge: Add Graph Edge, staged until Finalize
 	 */
 	void AddEdge(U_INT src, U_INT trg, S_INT cost) {
-		typedef boost::graph_traits<GraphT>::edge_descriptor edge_descriptor;
-		bool Ins;
-		edge_descriptor Edge;
-		boost::tie(Edge, Ins) = boost::add_edge(src,trg,hGraph);
-		if (!Ins) throw local_exception("Cannot insert graph data");
-		hGraph[Edge].cost=cost;
+		hArcs.push_back(GraphT::arc_type(src,trg,cost));
+		if (src>=hVerts) hVerts=src+1;
+		if (trg>=hVerts) hVerts=trg+1;
+	}
+	/**
+	 * AddEdges: take a whole staged arc array from a bulk loader in place of
+	 *           AddEdge calls, verts is one past the largest id
+	 */
+	void AddEdges(std::vector<GraphT::arc_type>& arcs, U_INT verts) {
+		hArcs.swap(arcs);
+		hVerts = std::max(hVerts, verts);
+	}
+	/**
+	 * Nodes: coordinate array sized to the vertices, for a bulk loader in
+	 *        place of ModifyNode calls
+	 */
+	std::vector<xNode>& Nodes() {
+		hNodes.resize(hVerts);
+		return hNodes;
 	}
 	/**
 	 * Modify Node: Add x,y to node
 	 */
 	void ModifyNode(U_INT vid, S_INT x, S_INT y) {
-		typedef boost::graph_traits<GraphT>::vertex_descriptor vertex_descriptor;
-		if (vid>=num_vertices(hGraph))
+		if (vid>=hVerts)
 			throw local_exception("Cannot insert graph data too large vid");
-		vertex_descriptor v = vertex(vid, hGraph);
-		hGraph[v].x = x;
-		hGraph[v].y = y;
+		if (hNodes.size()<hVerts) hNodes.resize(hVerts);
+		hNodes[vid].x = x;
+		hNodes[vid].y = y;
+	}
+	/**
+	 * Finalize: build the read-only graph from the staged edges, call once
+	 *           after loading and before searching, renumbers if asked,
+	 *           the arrays are sorted on threads when more than one
+	 */
+	void Finalize(size_t threads=1) {
+		hNodes.resize(hVerts);
+		hNumber.Build(hRenumber, hVerts, hArcs, hNodes.empty() ? 0 : &hNodes[0]);
+		hNumber.Apply(hArcs, hNodes);
+		ParallelCsr<GraphT>(threads).Build(hVerts, hArcs, hGraph);
+		std::vector<GraphT::arc_type>().swap(hArcs);
+		hCoords = hNodes.empty() ? 0 : &hNodes[0];
+		hPot.Build(hGraph, hCoords);
+		hSpatial.Build(hGraph, hCoords);
+	}
+	/**
+	 * WriteSnapshot: store the finalized graph and coordinates
+	 */
+	void WriteSnapshot(const char* File) const {
+		GraphSnapshot::Write(File, hGraph, hCoords, hNumber.Order());
+	}
+	/**
+	 * OpenSnapshot: map a snapshot, replaces AddEdge, ModifyNode and Finalize
+	 */
+	void OpenSnapshot(const char* File, bool verify) {
+		hSnap.reset(new GraphSnapshot(File, verify));
+		hSnap->Attach(hGraph);
+		hCoords = hSnap->Section<xNode>(SNAP_COORDS, hSnap->Vertices());
+		hVerts = hSnap->Vertices();
+		if (hSnap->Has(SNAP_ORDER))
+			hNumber.Assign(hSnap->Section<U_INT>(SNAP_ORDER, hVerts), hVerts);
+		std::vector<xNode>().swap(hNodes);
+		hPot.Build(hGraph, hCoords);
+		hSpatial.Build(hGraph, hCoords);
+	}
+	/**
+	 * PotentialScale: calibrated cost per coordinate unit
+	 */
+	double PotentialScale() const {
+		return hPot.Scale();
+	}
+	size_t NumVertices() const {
+		return num_vertices(hGraph);
+	}
+
+	/**
+	 * EnableUpdates: keep versioned weights so UpdateWeights may run while
+	 *                searches do
+	 */
+	void EnableUpdates() {
+		hUpdates.reset(new WeightVersions(hGraph.weights(), num_edges(hGraph)));
+	}
+	/**
+	 * CheckUpdate: null if cost may replace the weight of the arcs from src
+	 *              to trg (file ids), else the reason it may not
+	 */
+	const char* CheckUpdate(U_INT src, U_INT trg, S_INT cost) const {
+		if (!hUpdates) return "Weight updates not enabled";
+		if (src>=num_vertices(hGraph) || trg>=num_vertices(hGraph)) return "Update vertex out of range";
+		if (cost<0) return "Update cost negative";
+		U_INT u = hNumber.Internal(src), v = hNumber.Internal(trg);
+		bool found = false;
+		GraphT::out_edge_iterator ei, ei_end;
+		for (boost::tie(ei, ei_end) = out_edges(u, hGraph); ei != ei_end; ++ei) {
+			if (target(*ei, hGraph) != v) continue;
+			found = true;
+		}
+		if (!found) return "Update arc not in graph";
+		if (hPotential != POTENTIAL_SQUARED && !hPot.Admits(u, v, (U_INT)cost))
+			return "Update below coordinate bound";
+		return 0;
+	}
+	/**
+	 * UpdateWeights: new weight for every arc from src to trg of each entry,
+	 *                all are checked before any applies, searches running
+	 *                keep the version they started on; returns arcs changed
+	 */
+	size_t UpdateWeights(const std::vector<GraphT::arc_type>& batch) {
+		WeightVersions::BatchT changes;
+		for (size_t i=0; i<batch.size(); ++i) {
+			const char* why = CheckUpdate(batch[i].src, batch[i].trg, (S_INT)batch[i].weight);
+			if (why) throw local_exception(why);
+			U_INT u = hNumber.Internal(batch[i].src), v = hNumber.Internal(batch[i].trg);
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, hGraph); ei != ei_end; ++ei)
+				if (target(*ei, hGraph) == v)
+					changes.push_back(WeightVersions::change_type(ei->idx, batch[i].weight));
+		}
+		hUpdates->Apply(changes);
+		return changes.size();
+	}
+	/**
+	 * WeightVersion: updates applied so far
+	 */
+	uint64_t WeightVersion() const {
+		return (hUpdates) ? hUpdates->Version() : 0;
+	}
+	/**
+	 * SetRenumber: vertex order applied by Finalize, call before it, ids
+	 *              passed in and out stay the file ids
+	 */
+	void SetRenumber(renumber_kind kind) {
+		hRenumber = kind;
+	}
+	/**
+	 * SetQueue: priority queue for later searches
+	 */
+	void SetQueue(queue_kind kind) {
+		hQueue = kind;
+	}
+	/**
+	 * SetTermination: best stops on the goal through a stop predicate
+	 *                 instead of an exception, same paths
+	 */
+	void SetTermination(termination_kind kind) {
+		hTerm = kind;
+	}
+	/**
+	 * SetPotential: coordinate heuristic for later searches
+	 */
+	void SetPotential(potential_kind kind) {
+		hPotential = kind;
 	}
 
 	/**
-	 * Search: Astar Search by source,target
+	 * Snap: file id of the vertex with an arc nearest to x,y
+	 */
+	U_INT Snap(S_INT x, S_INT y) const {
+		SpatialIndex::MatchVecT m;
+		if (!hSpatial.Nearest(x, y, 1, m)) throw local_exception("No coordinates to snap to");
+		return hNumber.External(m[0].second);
+	}
+	/**
+	 * Nearest: file ids of up to k vertices nearest to x,y, closest first
+	 */
+	size_t Nearest(S_INT x, S_INT y, size_t k, std::vector<U_INT>& out) const {
+		SpatialIndex::MatchVecT m;
+		out.resize(hSpatial.Nearest(x, y, k, m));
+		for (size_t i=0; i<m.size(); ++i)
+			out[i] = hNumber.External(m[i].second);
+		return out.size();
+	}
+	/**
+	 * Search: Astar Search by source,target using the internal workspace
 	 */
 	template <typename T>
 	bool Search(U_INT src, U_INT trg, T& PathRes, U_INT& Cost) {
-		typedef boost::graph_traits<GraphT>::vertex_descriptor vertex_descriptor;
-		std::vector<vertex_descriptor> predecessors(num_vertices(hGraph));
+		return Search(src,trg,PathRes,Cost,hWork);
+	}
+	/**
+	 * Search: Astar Search by source,target, state kept in caller's workspace
+	 *         same as boost::astar_search_no_init but with the workspace queue
+	 */
+	template <typename T>
+	bool Search(U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
 		if (src>=num_vertices(hGraph) || trg>=num_vertices(hGraph)) return false;
-		vertex_descriptor source_vertex = vertex(src, hGraph);
-		vertex_descriptor target_vertex = vertex(trg, hGraph);
-		std::vector<U_INT> distances(num_vertices(hGraph));
-		typedef std::vector<boost::default_color_type> colormap_t;
-		colormap_t colors(num_vertices(hGraph));
-		try {
-			boost::astar_search(
-			    hGraph, source_vertex,
-			    distance_heuristic<GraphT>(hGraph, target_vertex),
-			    boost::predecessor_map(&predecessors[0]).
-			    weight_map(get(( &xEdge::cost ), hGraph)).
-			    distance_map(&distances[0]).
-			    color_map(&colors[0]).
-			    visitor(astar_goal_visitor<vertex_descriptor>(target_vertex)));
-		} catch (found_goal fg) {
-			Cost=distances[target_vertex];
-			PathRes.clear();
-			PathRes.push_front(target_vertex);
-			size_t max=num_vertices(hGraph);
-			while (target_vertex != source_vertex) {
-				if (target_vertex == predecessors[target_vertex])
-					return false;
-				target_vertex = predecessors[target_vertex];
-				PathRes.push_front(target_vertex);
-				if (!max--)
-					return false;
-			}
-			return true;
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		if (!SearchInternal(Weighted(pin, view), hNumber.Internal(src), hNumber.Internal(trg), PathRes, Cost, Work))
+			return false;
+		hNumber.Translate(PathRes);
+		return true;
+	}
+	/**
+	 * Search: as above from and to the vertices snapped to two positions
+	 */
+	template <typename T>
+	bool Search(const xNode& from, const xNode& to, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
+		return Search(Snap(from.x, from.y), Snap(to.x, to.y), PathRes, Cost, Work);
+	}
+	/**
+	 * MatrixTargets: prepare the columns of a distance matrix
+	 */
+	void MatrixTargets(const std::vector<U_INT>& targets, MatrixBuckets& B, WorkspaceT&) {
+		std::vector<U_INT> internal(targets);
+		for (size_t j=0; j<internal.size(); ++j)
+			internal[j] = hNumber.Internal(internal[j]);
+		MatrixSweepTargets(hGraph, internal, B);
+	}
+	/**
+	 * MatrixRow: costs from src to all prepared targets in one dijkstra sweep
+	 */
+	void MatrixRow(U_INT src, const MatrixBuckets& B, U_INT* row, WorkspaceT& Work) {
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		MatrixSweepRow(Weighted(pin, view), hNumber.Internal(src), B, row, Work);
+	}
+	/**
+	 * OneToAll: costs from src to every vertex by dijkstra
+	 */
+	void OneToAll(U_INT src, std::vector<U_INT>& dist, std::vector<U_INT>& level, WorkspaceT& Work) {
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		DijkstraOneToAll(Weighted(pin, view), hNumber.Internal(src), dist, Work);
+		hNumber.Permute(dist, level);
+	}
+	/**
+	 * Reachable: file ids within budget of src in ascending order and the
+	 *            arcs leaving them past the budget, by a budgeted dijkstra
+	 */
+	void Reachable(U_INT src, U_INT budget, std::vector<U_INT>& reached, std::vector<isochrone_arc>& boundary,
+	               WorkspaceT& Work) {
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		DijkstraBudget(Weighted(pin, view), hNumber.Internal(src), budget, reached, boundary, Work);
+		hNumber.Translate(reached);
+		std::sort(reached.begin(), reached.end());
+		for (size_t i=0; i<boundary.size(); ++i) {
+			boundary[i].src = hNumber.External(boundary[i].src);
+			boundary[i].trg = hNumber.External(boundary[i].trg);
 		}
-		return false;
 	}
 private:
+	/**
+	 * Weighted: the graph a search reads, a view on the pinned weights when
+	 *           updates are enabled
+	 */
+	const GraphT& Weighted(const WeightPin& pin, GraphT& view) const {
+		if (!pin.Active()) return hGraph;
+		view.view(hGraph, pin.Weights());
+		return view;
+	}
+	/**
+	 * SearchInternal: search on internal ids
+	 */
+	template <typename T>
+	bool SearchInternal(const GraphT& g, U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
+		switch (hQueue) {
+		case QUEUE_QUATERNARY:
+			return SearchHeuristic<Queue4T>(g, src, trg, PathRes, Cost, Work);
+		case QUEUE_RADIX:
+			return SearchHeuristic<RadixQueueT>(g, src, trg, PathRes, Cost, Work);
+		default:
+			return SearchHeuristic<QueueT>(g, src, trg, PathRes, Cost, Work);
+		}
+	}
+	/**
+	 * SearchHeuristic: picks the coordinate heuristic
+	 */
+	template <typename QueueType, typename T>
+	bool SearchHeuristic(const GraphT& g, U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
+		VertexT target_vertex = vertex(trg, g);
+		if (hPotential == POTENTIAL_SQUARED)
+			return SearchWith<QueueType>(g, src, trg, PathRes, Cost, Work,
+			                             distance_heuristic<GraphT>(hCoords, target_vertex));
+		PotentialMemo* memo = 0;
+		if (hPotential == POTENTIAL_MEMO) {
+			memo = &Work.memo();
+			memo->Reset(num_vertices(g));
+		}
+		return SearchWith<QueueType>(g, src, trg, PathRes, Cost, Work,
+		                             potential_heuristic<GraphT>(&hPot, target_vertex, memo));
+	}
+	/**
+	 * SearchWith: astar on queue type QueueType with heuristic h
+	 */
+	template <typename QueueType, typename T, typename HeuristicT>
+	bool SearchWith(const GraphT& g, U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work, HeuristicT h) {
+		typedef GraphT::weight_map_type WeightMapT;
+		typedef astar_goal_visitor<VertexT> VisitorT;
+		typedef boost::detail::astar_bfs_visitor<HeuristicT, VisitorT, QueueType,
+		        WorkspaceT::predecessor_map_type, WorkspaceT::cost_map_type,
+		        WorkspaceT::distance_map_type, WeightMapT, WorkspaceT::color_map_type,
+		        boost::closed_plus<U_INT>, std::less<U_INT> > BfsVisitorT;
+		VertexT source_vertex = vertex(src, g);
+		VertexT target_vertex = vertex(trg, g);
+		Work.reset(num_vertices(g), std::numeric_limits<U_INT>::max());
+		WorkspaceT::predecessor_map_type predecessors = Work.predecessor_map();
+		WorkspaceT::distance_map_type distances = Work.distance_map();
+		WorkspaceT::cost_map_type costs = Work.cost_map();
+		put(distances, source_vertex, 0);
+		put(costs, source_vertex, h(source_vertex));
+		QueueType Q(QueueType::storage(Work), costs, Work.index_in_heap_map());
+		BfsVisitorT bfs_vis(h, VisitorT(target_vertex, Work.stats().settled, Work.stats().forward,
+		                                     hTerm == TERMINATE_FIRST),
+		                    Q, predecessors, costs, distances,
+		                    g.weight_map(), Work.color_map(),
+		                    boost::closed_plus<U_INT>(), std::less<U_INT>(), 0U);
+		if (hTerm == TERMINATE_BEST) {
+			boost::tway_breadth_first_visit_until(g, source_vertex, Q, bfs_vis, Work.color_map(),
+			                                      astar_goal_stop<VertexT>(target_vertex));
+			if (Q.empty()) return false;
+		} else {
+			try {
+				boost::breadth_first_visit(g, source_vertex, Q, bfs_vis, Work.color_map());
+				return false;
+			} catch (found_goal fg) {}
+		}
+		Cost=get(distances, target_vertex);
+		PathRes.clear();
+		PathRes.push_back(target_vertex);
+		size_t max=num_vertices(g);
+		while (target_vertex != source_vertex) {
+			if (target_vertex == get(predecessors, target_vertex))
+				return false;
+			target_vertex = get(predecessors, target_vertex);
+			PathRes.push_back(target_vertex);
+			if (!max--)
+				return false;
+		}
+		std::reverse(PathRes.begin(), PathRes.end());
+		return true;
+	}
 	GraphT hGraph;
+	std::vector<xNode> hNodes;
+	const xNode* hCoords;
+	std::vector<GraphT::arc_type> hArcs;
+	boost::shared_ptr<GraphSnapshot> hSnap;
+	boost::shared_ptr<WeightVersions> hUpdates;
+	Potentials hPot;
+	SpatialIndex hSpatial;
+	U_INT hVerts;
+	queue_kind hQueue;
+	termination_kind hTerm;
+	potential_kind hPotential;
+	renumber_kind hRenumber;
+	Renumbering hNumber;
+	WorkspaceT hWork;
 };
 } // namespace TestAstar
 #endif
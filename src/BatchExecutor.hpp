@@ -0,0 +1,77 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_BATCH_EXECUTOR_HPP_
+#define _TESTASTAR_BATCH_EXECUTOR_HPP_
+#include "Locals.hh"
+#include "ChunkPool.hpp"
+#include <vector>
+#include <algorithm>
+#include <boost/bind.hpp>
+
+#define BATCH_CHUNK 64
+
+namespace TestAstar {
+/**
+ * BatchExecutor: runs a list of point to point queries on a ChunkPool of
+ *   BATCH_CHUNK queries. The graph is shared read only and results land in
+ *   the slot of their query so output order is kept. Paths are vectors, a
+ *   Run over the same out reuses their capacity.
+ */
+template <typename GraphType>
+class BatchExecutor {
+public:
+	typedef std::vector<std::pair<U_INT,U_INT> > VecPairT;
+	typedef std::vector<U_INT> PathT;
+	typedef std::vector<PathT> VecPathT;
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+
+	BatchExecutor(GraphType& g, size_t threads) : hGraph(g), hPool(threads, BATCH_CHUNK) {}
+	~BatchExecutor() {}
+
+	/**
+	 * Run: answer all queries in in, out and costs are resized to match,
+	 *      failed queries leave an empty path, returns number of successful
+	 *      queries
+	 */
+	size_t Run(const VecPairT& in, VecPathT& out, std::vector<U_INT>& costs) {
+		out.resize(in.size());
+		costs.assign(in.size(), 0);
+		hIn = &in;
+		hOut = &out;
+		hCosts = &costs;
+		return hPool.Run(in.size(), boost::bind(&BatchExecutor::Chunk, this, _1, _2, _3));
+	}
+	size_t Threads() const {
+		return hPool.Threads();
+	}
+private:
+	/**
+	 * Chunk: queries first..last, returns how many succeeded
+	 */
+	size_t Chunk(size_t first, size_t last, WorkspaceT& Work) {
+		size_t success=0;
+		for (size_t i=first; i<last; ++i) {
+			U_INT& cost=(*hCosts)[i];
+			if (hGraph.Search((*hIn)[i].first, (*hIn)[i].second, (*hOut)[i], cost, Work))
+				++success;
+			else
+				(*hOut)[i].clear();
+		}
+		return success;
+	}
+
+	GraphType& hGraph;
+	ChunkPool<WorkspaceT> hPool;
+	const VecPairT* hIn;
+	VecPathT* hOut;
+	std::vector<U_INT>* hCosts;
+};
+} // namespace TestAstar
+#endif
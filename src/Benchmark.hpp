@@ -0,0 +1,142 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_BENCHMARK_HPP_
+#define _TESTASTAR_BENCHMARK_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <stdint.h>
+#include "Timer.hpp"
+
+namespace TestAstar {
+
+/** bench_format: report layout, text for people, csv and json for scripts */
+enum bench_format { BENCH_TEXT, BENCH_CSV, BENCH_JSON };
+
+/**
+ * ParseBenchFormat: text, csv or json
+ */
+inline bench_format ParseBenchFormat(const char* name)
+{
+	if (!strcmp(name, "text")) return BENCH_TEXT;
+	if (!strcmp(name, "csv")) return BENCH_CSV;
+	if (!strcmp(name, "json")) return BENCH_JSON;
+	throw local_exception("Unknown benchmark format");
+}
+
+/**
+ * Benchmark: times every query on its own with the monotonic clock and
+ *   reports the latency distribution and settled vertex counts. Queries
+ *   run one at a time on one workspace so the numbers are per query
+ *   latencies, not throughput of a pool.
+ */
+template <typename GraphType>
+class Benchmark {
+public:
+	typedef std::vector<std::pair<U_INT,U_INT> > VecPairT;
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+
+	/** balance: label of the side policy of two way searches, for the report */
+	Benchmark(GraphType& g, const char* name, const char* balance)
+		: hGraph(g), hName(name), hBalance(balance), hSuccess(0), hTotal(0) {}
+	~Benchmark() {}
+
+	/**
+	 * Run: search every query once, path output is discarded
+	 */
+	void Run(const VecPairT& in) {
+		hNanos.assign(in.size(), 0);
+		hSettled.assign(in.size(), 0);
+		hForward.assign(in.size(), 0);
+		hSuccess = 0;
+		std::vector<U_INT> vlist;
+		uint64_t total = nanotimer();
+		for (size_t i=0; i<in.size(); ++i) {
+			U_INT cost=0;
+			uint64_t t = nanotimer();
+			bool bStat = hGraph.Search(in[i].first, in[i].second, vlist, cost, hWork);
+			hNanos[i] = nanotimer(t);
+			hSettled[i] = hWork.stats().settled;
+			hForward[i] = hWork.stats().forward;
+			if (bStat) ++hSuccess;
+		}
+		hTotal = nanotimer(total);
+	}
+	/**
+	 * Report: summary in the given format
+	 */
+	void Report(std::ostream& out, bench_format format) const {
+		std::vector<uint64_t> ns(hNanos), st(hSettled);
+		std::sort(ns.begin(), ns.end());
+		std::sort(st.begin(), st.end());
+		size_t n = ns.size();
+		double qps = (hTotal) ? n * 1e9 / hTotal : 0.0;
+		double mean = 0.0, fwd = 0.0;
+		for (size_t i=0; i<n; ++i) mean += st[i];
+		for (size_t i=0; i<n; ++i) fwd += hForward[i];
+		if (n) mean /= n;
+		if (n) fwd /= n;
+		const char* keys[] = { "min", "p50", "p90", "p99", "max" };
+		double lat[] = { Micros(ns, 0.0), Micros(ns, 0.5), Micros(ns, 0.9), Micros(ns, 0.99), Micros(ns, 1.0) };
+		out << std::fixed << std::setprecision(3);
+		switch (format) {
+		case BENCH_CSV:
+			out << "program,balance,queries,success,qps";
+			for (size_t i=0; i<5; ++i) out << "," << keys[i] << "_us";
+			out << ",settled_mean,settled_p50,settled_max,forward_mean" << std::endl;
+			out << hName << "," << hBalance << "," << n << "," << hSuccess << "," << qps;
+			for (size_t i=0; i<5; ++i) out << "," << lat[i];
+			out << "," << mean << "," << Rank(st, 0.5) << "," << Rank(st, 1.0) << "," << fwd << std::endl;
+			break;
+		case BENCH_JSON:
+			out << "{\"program\":\"" << hName << "\",\"balance\":\"" << hBalance << "\",\"queries\":" << n << ",\"success\":" << hSuccess
+			    << ",\"qps\":" << qps << ",\"latency_us\":{";
+			for (size_t i=0; i<5; ++i) out << ((i)?",":"") << "\"" << keys[i] << "\":" << lat[i];
+			out << "},\"settled\":{\"mean\":" << mean << ",\"p50\":" << Rank(st, 0.5)
+			    << ",\"max\":" << Rank(st, 1.0) << ",\"forward_mean\":" << fwd << "}}" << std::endl;
+			break;
+		default:
+			out << " Benchmark " << hName << ", Balance " << hBalance << ", Queries " << n << ", Success " << hSuccess
+			    << ", QPS " << qps << std::endl;
+			out << " Latency(us)";
+			for (size_t i=0; i<5; ++i) out << " " << keys[i] << " " << lat[i];
+			out << std::endl;
+			out << " Settled mean " << mean << " p50 " << Rank(st, 0.5) << " max " << Rank(st, 1.0)
+			    << " forward mean " << fwd << std::endl;
+			break;
+		}
+	}
+private:
+	/** Rank: nearest rank percentile of a sorted vector */
+	static uint64_t Rank(const std::vector<uint64_t>& v, double p) {
+		if (v.empty()) return 0;
+		size_t k = (size_t)(p * v.size() + 0.999999);
+		return v[(k) ? k-1 : 0];
+	}
+	static double Micros(const std::vector<uint64_t>& v, double p) {
+		return Rank(v, p) / 1000.0;
+	}
+
+	GraphType& hGraph;
+	std::string hName;
+	std::string hBalance;
+	WorkspaceT hWork;
+	std::vector<uint64_t> hNanos;
+	std::vector<uint64_t> hSettled;
+	std::vector<uint64_t> hForward;
+	size_t hSuccess;
+	uint64_t hTotal;
+};
+} // namespace TestAstar
+#endif
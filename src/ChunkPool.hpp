@@ -0,0 +1,88 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_CHUNK_POOL_HPP_
+#define _TESTASTAR_CHUNK_POOL_HPP_
+#include "Locals.hh"
+#include <algorithm>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+
+namespace TestAstar {
+/**
+ * ChunkPool: runs a job over the indexes 0..count on a worker pool. Every
+ *   worker owns one search workspace for all its calls and claims chunk
+ *   indexes at a time from a shared cursor; the job gets a range and the
+ *   workspace and returns a count, summed over all workers. One worker
+ *   runs on the calling thread when there is a single thread or chunk.
+ */
+template <typename WorkspaceT>
+class ChunkPool {
+public:
+	typedef boost::function<size_t (size_t, size_t, WorkspaceT&)> JobT;
+
+	ChunkPool(size_t threads, size_t chunk)
+		: hThreads(std::max(threads, (size_t)1)), hChunk(std::max(chunk, (size_t)1)) {}
+	~ChunkPool() {}
+
+	/**
+	 * Run: job(first, last, Work) over all chunks of 0..count, returns the
+	 *      sum of what the calls returned
+	 */
+	size_t Run(size_t count, JobT job) {
+		hJob = job;
+		hCount = count;
+		hNext = 0;
+		hTotal = 0;
+		if (hThreads == 1 || count <= hChunk) {
+			Worker();
+		} else {
+			boost::thread_group pool;
+			for (size_t i=0; i<hThreads; ++i)
+				pool.create_thread(boost::bind(&ChunkPool::Worker, this));
+			pool.join_all();
+		}
+		return hTotal;
+	}
+	size_t Threads() const {
+		return hThreads;
+	}
+private:
+	/**
+	 * Claim: next chunk of indexes, false when all are taken
+	 */
+	bool Claim(size_t& first, size_t& last) {
+		boost::mutex::scoped_lock lock(hMutex);
+		if (hNext >= hCount) return false;
+		first = hNext;
+		last = std::min(hNext + hChunk, hCount);
+		hNext = last;
+		return true;
+	}
+	void Worker() {
+		WorkspaceT Work;
+		size_t first = 0, last = 0, total = 0;
+		while (Claim(first, last))
+			total += hJob(first, last, Work);
+		boost::mutex::scoped_lock lock(hMutex);
+		hTotal += total;
+	}
+
+	size_t hThreads;
+	size_t hChunk;
+	JobT hJob;
+	size_t hCount;
+	size_t hNext;
+	size_t hTotal;
+	boost::mutex hMutex;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,561 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_CONTRACTION_HIERARCHY_HPP_
+#define _TESTASTAR_CONTRACTION_HIERARCHY_HPP_
+#include "Locals.hh"
+#include "SearchOptions.hpp"
+#include "DistanceMatrix.hpp"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <boost/graph/tway_csr_graph.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+#include <boost/graph/tway_queue.hpp>
+#include <boost/graph/tway_breadth_first_visit.hpp>
+#include <boost/graph/tway_relax.hpp>
+
+#define CH_NO_CHILD      0xFFFFFFFFU
+#define CH_WITNESS_LIMIT 500
+
+namespace TestAstar {
+
+/**
+ * ch_query_stop: stop predicate, queue minimum reached the best meeting
+ */
+template <typename DistanceMap>
+struct ch_query_stop {
+public:
+	ch_query_stop(DistanceMap dist, const U_INT& best) : m_dist(dist), m_best(best) {}
+	template <typename Vertex>
+	bool operator()(Vertex u) const {
+		return get(m_dist, u) >= m_best;
+	}
+private:
+	DistanceMap m_dist;
+	const U_INT& m_best;
+};
+
+/**
+ * ch_query_visitor: tbfs visitor for the upward searches, a vertex settled
+ *   on one side whose copy was reached by the other side gives a meeting
+ */
+template <typename GraphType, typename WorkspaceType, typename QueueType>
+struct ch_query_visitor : public boost::default_tbfs_visitor {
+public:
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor Vertex;
+	typedef typename boost::graph_traits<GraphType>::edge_descriptor Edge;
+	typedef boost::color_traits<boost::tway_color_type> Color;
+
+	ch_query_visitor(WorkspaceType& w, QueueType& Q, Vertex n, const bool& is_fwd, U_INT& best, Vertex& meet)
+		: m_Q(Q), m_settled(w.stats().settled), m_dist(w.distance_map()), m_pred(w.predecessor_map()), m_color(w.color_map()),
+		  m_n(n), is_fwd_(is_fwd), m_best(best), m_meet(meet) {}
+
+	template <class Graph>
+	void examine_vertex(Vertex u, Graph&) {
+		++m_settled;
+		Vertex v = (u < m_n) ? u + m_n : u - m_n;
+		if (get(m_color, v) == Color::white()) return;
+		U_INT d = m_combine(get(m_dist, u), get(m_dist, v));
+		if (d < m_best) {
+			m_best = d;
+			m_meet = (u < m_n) ? u : v;
+		}
+	}
+	template <class Graph>
+	void tree_edge(Edge e, Graph& g) {
+		relax(e, g);
+	}
+	template <class Graph>
+	void gray_target(Edge e, Graph& g) {
+		if (relax(e, g)) m_Q.update((is_fwd_) ? target(e,g) : source(e,g));
+	}
+private:
+	template <class Graph>
+	bool relax(Edge e, Graph& g) {
+		return boost::tway_relax(e, g, g.weight_map(), m_pred, m_dist, m_combine, m_compare, is_fwd_);
+	}
+	QueueType& m_Q;
+	std::size_t& m_settled;
+	typename WorkspaceType::distance_map_type m_dist;
+	typename WorkspaceType::predecessor_map_type m_pred;
+	typename WorkspaceType::color_map_type m_color;
+	boost::closed_plus<U_INT> m_combine;
+	std::less<U_INT> m_compare;
+	Vertex m_n;
+	const bool& is_fwd_;
+	U_INT& m_best;
+	Vertex& m_meet;
+};
+
+/**
+ * ContractionHierarchy: node ordering by edge difference, witness searches,
+ *   shortcut creation, and a bidirectional upward query on the hierarchy.
+ *
+ * The query graph has two copies of every vertex: forward copy v holding
+ * the upward arcs as out edges, backward copy v+n holding the downward arcs
+ * as in edges. The silver search runs on forward copies and the gold one on
+ * backward copies, so the same road vertex can be settled from both sides
+ * as the hierarchy query requires.
+ */
+class ContractionHierarchy {
+public:
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef boost::tway_search_workspace<VertexT, U_INT, boost::tway_color_type> WorkspaceT;
+	typedef boost::tway_indexed_heap<VertexT, WorkspaceT::distance_map_type, WorkspaceT::index_in_heap_map_type> QueueT;
+	typedef boost::tway_dary_heap<VertexT, 4, WorkspaceT::distance_map_type, WorkspaceT::index_in_heap_map_type> Queue4T;
+	typedef boost::tway_radix_heap<VertexT, WorkspaceT::distance_map_type, WorkspaceT::index_in_heap_map_type> RadixQueueT;
+
+	/** ChArc: original arc or shortcut over child1 then child2 */
+	struct ChArc {
+		ChArc(U_INT s, U_INT t, U_INT w, U_INT c1=CH_NO_CHILD, U_INT c2=CH_NO_CHILD)
+			: src(s), trg(t), weight(w), child1(c1), child2(c2) {}
+		U_INT src;
+		U_INT trg;
+		U_INT weight;
+		U_INT child1;
+		U_INT child2;
+	};
+
+	ContractionHierarchy() : hVerts(0), hShortcuts(0) {}
+	~ContractionHierarchy() {}
+
+	/**
+	 * Build: contract all vertices of g and build the query graph
+	 */
+	void Build(const GraphT& g) {
+		hVerts = num_vertices(g);
+		hArcs.clear();
+		hOut.assign(hVerts, std::vector<U_INT>());
+		hIn.assign(hVerts, std::vector<U_INT>());
+		for (U_INT u=0; u<hVerts; ++u) {
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				if (target(*ei,g)==u) continue; // self loops never lie on shortest paths
+				AddArc(ChArc(u, target(*ei,g), get(g.weight_map(), *ei)));
+			}
+		}
+		hShortcuts = 0;
+		hRank.assign(hVerts, 0);
+		hContracted.assign(hVerts, false);
+		hDeleted.assign(hVerts, 0);
+		typedef std::pair<S_INT,U_INT> PrioT;
+		std::priority_queue<PrioT, std::vector<PrioT>, std::greater<PrioT> > PQ;
+		for (U_INT v=0; v<hVerts; ++v)
+			PQ.push(PrioT(Priority(v), v));
+		U_INT rank=0;
+		while (!PQ.empty()) {
+			U_INT v = PQ.top().second;
+			PQ.pop();
+			if (hContracted[v]) continue;
+			S_INT p = Priority(v);
+			if (!PQ.empty() && p > PQ.top().first) {
+				PQ.push(PrioT(p, v));
+				continue;
+			}
+			Contract(v, false);
+			hContracted[v] = true;
+			hRank[v] = rank++;
+		}
+		BuildQueryGraph();
+	}
+	size_t Shortcuts() const {
+		return hShortcuts;
+	}
+	bool Empty() const {
+		return hVerts==0;
+	}
+
+	/**
+	 * Search: shortest path on the hierarchy, path unpacked to original ids
+	 */
+	template <typename T>
+	bool Search(U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work, queue_kind kind=QUEUE_BINARY) {
+		if (src>=hVerts || trg>=hVerts) return false;
+		switch (kind) {
+		case QUEUE_QUATERNARY:
+			return Query<Queue4T>(src, trg, PathRes, Cost, Work);
+		case QUEUE_RADIX:
+			return Query<RadixQueueT>(src, trg, PathRes, Cost, Work);
+		default:
+			return Query<QueueT>(src, trg, PathRes, Cost, Work);
+		}
+	}
+
+	/**
+	 * MatrixTargets: backward upward search from every target, each settled
+	 *                vertex gets a bucket entry with the target column
+	 */
+	void MatrixTargets(const std::vector<U_INT>& targets, MatrixBuckets& B, WorkspaceT& Work) {
+		B.Start(hVerts, targets.size());
+		for (size_t j=0; j<targets.size(); ++j) {
+			if (targets[j]>=hVerts) continue;
+			bucket_fill fill(B, j);
+			Upward(targets[j], false, Work, fill);
+		}
+		B.Finish();
+	}
+	/**
+	 * MatrixRow: forward upward search from src, every settled vertex scans
+	 *            its bucket, row entries keep the cheapest meeting
+	 */
+	void MatrixRow(U_INT src, const MatrixBuckets& B, U_INT* row, WorkspaceT& Work) {
+		if (src>=hVerts) return;
+		bucket_scan scan(B, row);
+		Upward(src, true, Work, scan);
+	}
+
+	/**
+	 * OneToAll: PHAST sweep, upward search from src then one pass over the
+	 *           downward arcs in descending rank, level is the sweep buffer
+	 *           in rank order, dist gets costs by original id
+	 */
+	void OneToAll(U_INT src, std::vector<U_INT>& dist, std::vector<U_INT>& level, WorkspaceT& Work) {
+		const U_INT inf = std::numeric_limits<U_INT>::max();
+		dist.assign(hVerts, inf);
+		if (src>=hVerts) return;
+		level.assign(hVerts, inf);
+		level_fill fill(level, hLevel);
+		Upward(src, true, Work, fill);
+		for (size_t p=0; p<hVerts; ++p) {
+			U_INT dp = level[p];
+			for (U_INT i=hSweepFirst[p]; i<hSweepFirst[p+1]; ++i) {
+				U_INT du = level[hSweepArcs[i].first];
+				if (du != inf && du + hSweepArcs[i].second < dp) dp = du + hSweepArcs[i].second;
+			}
+			level[p] = dp;
+		}
+		for (size_t v=0; v<hVerts; ++v)
+			dist[v] = level[hLevel[v]];
+	}
+
+private:
+	/**
+	 * Query: upward searches from both copies on queue type QueueType
+	 */
+	template <typename QueueType, typename T>
+	bool Query(U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		VertexT s = src, t = trg+hVerts;
+		Work.reset(num_vertices(hQuery), std::numeric_limits<U_INT>::max());
+		WorkspaceT::distance_map_type dist = Work.distance_map();
+		WorkspaceT::color_map_type color = Work.color_map();
+		put(dist, s, 0);
+		put(color, s, Color::silver());
+		put(dist, t, 0);
+		put(color, t, Color::gold());
+		QueueType Q(QueueType::storage(Work), dist, Work.index_in_heap_map());
+		U_INT best = std::numeric_limits<U_INT>::max();
+		VertexT meet = s;
+		bool is_fwd = true;
+		ch_query_visitor<GraphT, WorkspaceT, QueueType> vis(Work, Q, hVerts, is_fwd, best, meet);
+		boost::tway_breadth_first_visit(hQuery, s, t, Q, vis, color, is_fwd,
+		                                ch_query_stop<WorkspaceT::distance_map_type>(dist, best));
+		if (best == std::numeric_limits<U_INT>::max()) return false;
+		Cost = best;
+		Unpack(meet, s, t, PathRes, Work);
+		return true;
+	}
+	/** bucket_fill: Upward callback of MatrixTargets */
+	struct bucket_fill {
+		bucket_fill(MatrixBuckets& B, U_INT column) : m_B(B), m_column(column) {}
+		void operator()(U_INT v, U_INT d) {
+			m_B.Add(v, m_column, d);
+		}
+		MatrixBuckets& m_B;
+		U_INT m_column;
+	};
+	/** level_fill: Upward callback of OneToAll */
+	struct level_fill {
+		level_fill(std::vector<U_INT>& level, const std::vector<U_INT>& pos) : m_level(level), m_pos(pos) {}
+		void operator()(U_INT v, U_INT d) {
+			m_level[m_pos[v]] = d;
+		}
+		std::vector<U_INT>& m_level;
+		const std::vector<U_INT>& m_pos;
+	};
+	/** bucket_scan: Upward callback of MatrixRow */
+	struct bucket_scan {
+		bucket_scan(const MatrixBuckets& B, U_INT* row) : m_B(B), m_row(row) {}
+		void operator()(U_INT v, U_INT d) {
+			for (const MatrixBuckets::EntryT* e=m_B.Begin(v); e!=m_B.End(v); ++e)
+				if (d + e->second < m_row[e->first]) m_row[e->first] = d + e->second;
+		}
+		const MatrixBuckets& m_B;
+		U_INT* m_row;
+	};
+	/**
+	 * Upward: complete upward dijkstra from v, on forward copies over out
+	 *         edges or on backward copies over in edges, fn gets every
+	 *         settled vertex as original id with its distance
+	 */
+	template <typename Callback>
+	void Upward(U_INT v, bool fwd, WorkspaceT& Work, Callback& fn) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		Work.reset(num_vertices(hQuery), std::numeric_limits<U_INT>::max());
+		WorkspaceT::distance_map_type dist = Work.distance_map();
+		WorkspaceT::color_map_type color = Work.color_map();
+		QueueT Q(Work.heap_storage(), dist, Work.index_in_heap_map());
+		VertexT s = (fwd) ? v : v+hVerts;
+		put(dist, s, 0);
+		put(color, s, Color::gray());
+		Q.push(s);
+		while (!Q.empty()) {
+			VertexT u = Q.top();
+			Q.pop();
+			put(color, u, Color::black());
+			++Work.stats().settled;
+			U_INT du = get(dist, u);
+			fn((fwd) ? u : u-hVerts, du);
+			if (fwd) {
+				GraphT::out_edge_iterator ei, ei_end;
+				for (boost::tie(ei, ei_end) = out_edges(u, hQuery); ei != ei_end; ++ei)
+					Reach(target(*ei, hQuery), du + get(hQuery.weight_map(), *ei), Q, dist, color);
+			} else {
+				GraphT::in_edge_iterator ei, ei_end;
+				for (boost::tie(ei, ei_end) = in_edges(u, hQuery); ei != ei_end; ++ei)
+					Reach(source(*ei, hQuery), du + get(hQuery.weight_map(), *ei), Q, dist, color);
+			}
+		}
+	}
+	/** Reach: label y with dy unless it already has a better one */
+	void Reach(VertexT y, U_INT dy, QueueT& Q, WorkspaceT::distance_map_type dist, WorkspaceT::color_map_type color) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		if (get(color, y) == Color::white()) {
+			put(dist, y, dy);
+			put(color, y, Color::gray());
+			Q.push(y);
+		} else if (get(color, y) == Color::gray() && dy < get(dist, y)) {
+			put(dist, y, dy);
+			Q.update(y);
+		}
+	}
+	void AddArc(const ChArc& a) {
+		hOut[a.src].push_back(hArcs.size());
+		hIn[a.trg].push_back(hArcs.size());
+		hArcs.push_back(a);
+	}
+	/**
+	 * Neighbours: cheapest arc to each uncontracted neighbour, sorted by id
+	 */
+	void Neighbours(const std::vector<U_INT>& list, bool out, U_INT v, std::vector<std::pair<U_INT,U_INT> >& res) {
+		res.clear();
+		for (size_t i=0; i<list.size(); ++i) {
+			const ChArc& a = hArcs[list[i]];
+			U_INT w = out ? a.trg : a.src;
+			if (w==v || hContracted[w]) continue;
+			res.push_back(std::make_pair(w, list[i]));
+		}
+		std::sort(res.begin(), res.end(), ArcLess(this));
+		size_t k=0;
+		for (size_t i=0; i<res.size(); ++i) {
+			if (k && res[k-1].first == res[i].first) continue;
+			res[k++] = res[i];
+		}
+		res.resize(k);
+	}
+	struct ArcLess {
+		ArcLess(const ContractionHierarchy* ch) : m_ch(ch) {}
+		bool operator()(const std::pair<U_INT,U_INT>& a, const std::pair<U_INT,U_INT>& b) const {
+			if (a.first != b.first) return a.first < b.first;
+			return m_ch->hArcs[a.second].weight < m_ch->hArcs[b.second].weight;
+		}
+		const ContractionHierarchy* m_ch;
+	};
+	/**
+	 * Witness: local dijkstra from u avoiding v, bounded by limit and by
+	 *          CH_WITNESS_LIMIT settled vertices, distances left in hWitness
+	 */
+	void Witness(U_INT u, U_INT v, U_INT limit) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		hWitness.reset(hVerts, std::numeric_limits<U_INT>::max());
+		WorkspaceT::distance_map_type dist = hWitness.distance_map();
+		WorkspaceT::color_map_type color = hWitness.color_map();
+		QueueT Q(hWitness.heap_storage(), dist, hWitness.index_in_heap_map());
+		put(dist, u, 0);
+		put(color, u, Color::gray());
+		Q.push(u);
+		size_t settled=0;
+		while (!Q.empty() && settled<CH_WITNESS_LIMIT) {
+			U_INT x = Q.top();
+			Q.pop();
+			U_INT dx = get(dist, x);
+			if (dx > limit) break;
+			put(color, x, Color::black());
+			++settled;
+			const std::vector<U_INT>& out = hOut[x];
+			for (size_t i=0; i<out.size(); ++i) {
+				const ChArc& a = hArcs[out[i]];
+				U_INT y = a.trg;
+				if (y==v || hContracted[y]) continue;
+				U_INT dy = dx + a.weight;
+				if (get(color, y) == Color::white()) {
+					put(dist, y, dy);
+					put(color, y, Color::gray());
+					Q.push(y);
+				} else if (get(color, y) == Color::gray() && dy < get(dist, y)) {
+					put(dist, y, dy);
+					Q.update(y);
+				}
+			}
+		}
+	}
+	/**
+	 * Contract: shortcuts needed to remove v, added unless simulate
+	 */
+	size_t Contract(U_INT v, bool simulate) {
+		std::vector<std::pair<U_INT,U_INT> > ins, outs;
+		Neighbours(hIn[v], false, v, ins);
+		Neighbours(hOut[v], true, v, outs);
+		size_t added=0;
+		for (size_t i=0; i<ins.size(); ++i) {
+			U_INT u = ins[i].first;
+			U_INT wu = hArcs[ins[i].second].weight;
+			U_INT limit = 0;
+			for (size_t j=0; j<outs.size(); ++j)
+				if (outs[j].first != u)
+					limit = std::max(limit, wu + hArcs[outs[j].second].weight);
+			if (!limit) continue;
+			Witness(u, v, limit);
+			for (size_t j=0; j<outs.size(); ++j) {
+				U_INT w = outs[j].first;
+				if (w == u) continue;
+				U_INT via = wu + hArcs[outs[j].second].weight;
+				if (get(hWitness.distance_map(), w) <= via) continue;
+				++added;
+				if (!simulate) {
+					AddArc(ChArc(u, w, via, ins[i].second, outs[j].second));
+					++hShortcuts;
+				}
+			}
+		}
+		if (!simulate) {
+			for (size_t i=0; i<ins.size(); ++i) ++hDeleted[ins[i].first];
+			for (size_t j=0; j<outs.size(); ++j) ++hDeleted[outs[j].first];
+		}
+		hDegree = ins.size() + outs.size();
+		return added;
+	}
+	/**
+	 * Priority: edge difference plus contracted neighbours
+	 */
+	S_INT Priority(U_INT v) {
+		S_INT shortcuts = Contract(v, true);
+		return shortcuts - (S_INT)hDegree + (S_INT)hDeleted[v];
+	}
+	/**
+	 * BuildQueryGraph: upward arcs on forward copies, downward arcs on
+	 *                  backward copies
+	 */
+	void BuildQueryGraph() {
+		std::vector<GraphT::arc_type> arcs;
+		arcs.reserve(hArcs.size());
+		for (size_t i=0; i<hArcs.size(); ++i) {
+			const ChArc& a = hArcs[i];
+			if (hRank[a.src] < hRank[a.trg])
+				arcs.push_back(GraphT::arc_type(a.src, a.trg, a.weight));
+			else
+				arcs.push_back(GraphT::arc_type(a.src+hVerts, a.trg+hVerts, a.weight));
+		}
+		hQuery.assign(2*hVerts, arcs.begin(), arcs.end());
+		BuildSweep();
+		std::vector<bool>().swap(hContracted);
+		std::vector<U_INT>().swap(hDeleted);
+	}
+	/**
+	 * BuildSweep: sweep position of every vertex, highest rank first, and
+	 *             the downward arcs grouped by target position holding the
+	 *             source position, a counting sort over the arcs
+	 */
+	void BuildSweep() {
+		hLevel.resize(hVerts);
+		for (size_t v=0; v<hVerts; ++v)
+			hLevel[v] = hVerts - 1 - hRank[v];
+		hSweepFirst.assign(hVerts+1, 0);
+		for (size_t i=0; i<hArcs.size(); ++i)
+			if (hRank[hArcs[i].src] > hRank[hArcs[i].trg]) ++hSweepFirst[hLevel[hArcs[i].trg]+1];
+		for (size_t p=0; p<hVerts; ++p)
+			hSweepFirst[p+1] += hSweepFirst[p];
+		hSweepArcs.resize(hSweepFirst[hVerts]);
+		std::vector<U_INT> pos(hSweepFirst.begin(), hSweepFirst.end()-1);
+		for (size_t i=0; i<hArcs.size(); ++i) {
+			const ChArc& a = hArcs[i];
+			if (hRank[a.src] > hRank[a.trg])
+				hSweepArcs[pos[hLevel[a.trg]]++] = std::make_pair(hLevel[a.src], a.weight);
+		}
+	}
+	/**
+	 * Cheapest: id of the cheapest arc u -> w
+	 */
+	U_INT Cheapest(U_INT u, U_INT w) const {
+		U_INT best = CH_NO_CHILD;
+		for (size_t i=0; i<hOut[u].size(); ++i) {
+			const ChArc& a = hArcs[hOut[u][i]];
+			if (a.trg == w && (best==CH_NO_CHILD || a.weight < hArcs[best].weight))
+				best = hOut[u][i];
+		}
+		return best;
+	}
+	/**
+	 * Expand: append original vertices of arc id after its source
+	 */
+	template <typename T>
+	void Expand(U_INT id, T& PathRes) const {
+		std::vector<U_INT> stack(1, id);
+		while (!stack.empty()) {
+			const ChArc& a = hArcs[stack.back()];
+			stack.pop_back();
+			if (a.child1 == CH_NO_CHILD) {
+				PathRes.push_back(a.trg);
+				continue;
+			}
+			stack.push_back(a.child2);
+			stack.push_back(a.child1);
+		}
+	}
+	/**
+	 * Unpack: query graph path through the meeting vertex to original ids
+	 */
+	template <typename T>
+	void Unpack(VertexT meet, VertexT s, VertexT t, T& PathRes, WorkspaceT& Work) const {
+		WorkspaceT::predecessor_map_type pred = Work.predecessor_map();
+		std::vector<U_INT> hops;
+		for (VertexT v=meet; v!=s; v=get(pred, v))
+			hops.push_back(v);
+		hops.push_back(s);
+		std::reverse(hops.begin(), hops.end());
+		for (VertexT v=meet+hVerts; v!=t; ) {
+			v=get(pred, v);
+			hops.push_back(v-hVerts);
+		}
+		PathRes.clear();
+		PathRes.push_back(hops[0]);
+		for (size_t i=1; i<hops.size(); ++i)
+			Expand(Cheapest(hops[i-1], hops[i]), PathRes);
+	}
+
+	size_t hVerts;
+	size_t hShortcuts;
+	size_t hDegree;
+	std::vector<ChArc> hArcs;
+	std::vector<std::vector<U_INT> > hOut, hIn;
+	std::vector<U_INT> hRank;
+	std::vector<U_INT> hLevel;
+	std::vector<U_INT> hSweepFirst;
+	std::vector<std::pair<U_INT,U_INT> > hSweepArcs;
+	std::vector<bool> hContracted;
+	std::vector<U_INT> hDeleted;
+	WorkspaceT hWitness;
+	GraphT hQuery;
+};
+} // namespace TestAstar
+#endif
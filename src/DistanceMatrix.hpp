@@ -0,0 +1,200 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_DISTANCE_MATRIX_HPP_
+#define _TESTASTAR_DISTANCE_MATRIX_HPP_
+#include "Locals.hh"
+#include "ChunkPool.hpp"
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <boost/bind.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/tway_queue.hpp>
+
+#define MATRIX_CHUNK 16
+
+namespace TestAstar {
+
+/**
+ * MatrixBuckets: the targets of a matrix prepared once for all rows. For
+ *   every vertex the (column, distance) entries of the targets reached
+ *   there, in one flat array indexed by First. A plain sweep puts each
+ *   target in its own bucket at distance 0, a hierarchy puts it in every
+ *   bucket its backward upward search settles.
+ */
+class MatrixBuckets {
+public:
+	typedef std::pair<U_INT,U_INT> EntryT;
+
+	MatrixBuckets() : hColumns(0) {}
+	/**
+	 * Start: begin collecting for n vertices and columns targets
+	 */
+	void Start(size_t n, size_t columns) {
+		hColumns = columns;
+		hFirst.assign(n+1, 0);
+		hRaw.clear();
+		hEntries.clear();
+	}
+	/** Add: target column reaches v at distance d */
+	void Add(U_INT v, U_INT column, U_INT d) {
+		hRaw.push_back(RawT(v, EntryT(column, d)));
+		++hFirst[v+1];
+	}
+	/**
+	 * Finish: counting sort of the collected entries by vertex
+	 */
+	void Finish() {
+		for (size_t v=1; v<hFirst.size(); ++v)
+			hFirst[v] += hFirst[v-1];
+		hEntries.resize(hRaw.size());
+		std::vector<U_INT> pos(hFirst.begin(), hFirst.end()-1);
+		for (size_t i=0; i<hRaw.size(); ++i)
+			hEntries[pos[hRaw[i].first]++] = hRaw[i].second;
+		std::vector<RawT>().swap(hRaw);
+	}
+	size_t Columns() const {
+		return hColumns;
+	}
+	/** Entries: bucket entries in all, a plain sweep waits for each of them */
+	size_t Entries() const {
+		return hEntries.size();
+	}
+	const EntryT* Begin(U_INT v) const {
+		return hEntries.empty() ? 0 : &hEntries[0] + hFirst[v];
+	}
+	const EntryT* End(U_INT v) const {
+		return hEntries.empty() ? 0 : &hEntries[0] + hFirst[v+1];
+	}
+	static U_INT Infinity() {
+		return std::numeric_limits<U_INT>::max();
+	}
+private:
+	typedef std::pair<U_INT,EntryT> RawT;
+	size_t hColumns;
+	std::vector<U_INT> hFirst;
+	std::vector<RawT> hRaw;
+	std::vector<EntryT> hEntries;
+};
+
+/**
+ * MatrixSweepTargets: buckets of a plain sweep, every valid target in its
+ *                     own bucket
+ */
+template <typename GraphType>
+void MatrixSweepTargets(const GraphType& g, const std::vector<U_INT>& targets, MatrixBuckets& B)
+{
+	size_t n = num_vertices(g);
+	B.Start(n, targets.size());
+	for (size_t j=0; j<targets.size(); ++j)
+		if (targets[j] < n) B.Add(targets[j], j, 0);
+	B.Finish();
+}
+
+/**
+ * MatrixSweepRow: one dijkstra from source filling row, stops as soon as
+ *                 every target bucket has been settled
+ */
+template <typename GraphType, typename WorkspaceType>
+void MatrixSweepRow(const GraphType& g, U_INT source, const MatrixBuckets& B, U_INT* row, WorkspaceType& Work)
+{
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexT;
+	typedef typename WorkspaceType::distance_map_type DistanceMapT;
+	typedef boost::tway_indexed_heap<VertexT, DistanceMapT, typename WorkspaceType::index_in_heap_map_type> QueueT;
+	typedef boost::color_traits<typename WorkspaceType::color_type> Color;
+	size_t n = num_vertices(g);
+	if (source >= n) return;
+	Work.reset(n, MatrixBuckets::Infinity());
+	DistanceMapT d = Work.distance_map();
+	typename WorkspaceType::color_map_type color = Work.color_map();
+	QueueT Q(Work.heap_storage(), d, Work.index_in_heap_map());
+	size_t remaining = B.Entries();
+	put(d, source, 0);
+	put(color, source, Color::gray());
+	Q.push(source);
+	while (!Q.empty() && remaining) {
+		VertexT u = Q.top();
+		Q.pop();
+		put(color, u, Color::black());
+		++Work.stats().settled;
+		U_INT du = get(d, u);
+		for (const MatrixBuckets::EntryT* e=B.Begin(u); e!=B.End(u); ++e) {
+			row[e->first] = du;
+			--remaining;
+		}
+		typename boost::graph_traits<GraphType>::out_edge_iterator ei, ei_end;
+		for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+			VertexT v = target(*ei, g);
+			U_INT dv = du + get(g.weight_map(), *ei);
+			if (get(color, v) == Color::white()) {
+				put(d, v, dv);
+				put(color, v, Color::gray());
+				Q.push(v);
+			} else if (get(color, v) == Color::gray() && dv < get(d, v)) {
+				put(d, v, dv);
+				Q.update(v);
+			}
+		}
+	}
+}
+
+/**
+ * DistanceMatrix: costs of all source to target pairs, no paths. The graph
+ *   prepares the targets once (MatrixTargets) and answers one row per
+ *   source (MatrixRow) on a ChunkPool of MATRIX_CHUNK rows.
+ */
+template <typename GraphType>
+class DistanceMatrix {
+public:
+	typedef std::vector<U_INT> VecT;
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+
+	DistanceMatrix(GraphType& g, size_t threads) : hGraph(g), hPool(threads, MATRIX_CHUNK) {}
+	~DistanceMatrix() {}
+
+	/**
+	 * Run: out is the sources x targets matrix row by row, unreachable or
+	 *      invalid pairs hold Infinity, returns the finite entry count
+	 */
+	size_t Run(const VecT& sources, const VecT& targets, VecT& out) {
+		out.assign(sources.size() * targets.size(), MatrixBuckets::Infinity());
+		hSources = &sources;
+		hOut = &out;
+		{
+			WorkspaceT Work;
+			hGraph.MatrixTargets(targets, hBuckets, Work);
+		}
+		if (hBuckets.Columns())
+			hPool.Run(sources.size(), boost::bind(&DistanceMatrix::Chunk, this, _1, _2, _3));
+		size_t finite = 0;
+		for (size_t i=0; i<out.size(); ++i)
+			if (out[i] != MatrixBuckets::Infinity()) ++finite;
+		return finite;
+	}
+	static U_INT Infinity() {
+		return MatrixBuckets::Infinity();
+	}
+private:
+	/** Chunk: rows first..last */
+	size_t Chunk(size_t first, size_t last, WorkspaceT& Work) {
+		size_t columns = hBuckets.Columns();
+		for (size_t i=first; i<last; ++i)
+			hGraph.MatrixRow((*hSources)[i], hBuckets, &(*hOut)[i*columns], Work);
+		return 0;
+	}
+
+	GraphType& hGraph;
+	ChunkPool<WorkspaceT> hPool;
+	MatrixBuckets hBuckets;
+	const VecT* hSources;
+	VecT* hOut;
+};
+} // namespace TestAstar
+#endif
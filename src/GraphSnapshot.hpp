@@ -0,0 +1,259 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _GRAPH_SNAPSHOT_HPP_
+#define _GRAPH_SNAPSHOT_HPP_
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <stdint.h>
+#include <boost/shared_ptr.hpp>
+#include "Locals.hh"
+#include "MappedFile.hpp"
+
+/**
+ * Snapshot file layout, native endian:
+ *   SnapshotHeader
+ *   sections, each starting on a SNAPSHOT_ALIGN boundary:
+ *     offsets (V+1), targets (E), weights (E),
+ *     rev_offsets (V+1), rev_sources (E), rev_edges (E), coords (V),
+ *     order (V, or empty when the file ids are kept)
+ *   the header holds a checksum of itself and one of all section bytes
+ */
+#define SNAPSHOT_MAGIC   "TWAYSNAP"
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_ENDIAN  0x01020304
+#define SNAPSHOT_ALIGN   64
+
+namespace TestAstar {
+
+enum snapshot_section {
+	SNAP_OFFSETS, SNAP_TARGETS, SNAP_WEIGHTS,
+	SNAP_REV_OFFSETS, SNAP_REV_SOURCES, SNAP_REV_EDGES,
+	SNAP_COORDS, SNAP_ORDER, SNAP_SECTIONS
+};
+
+struct SnapshotHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint64_t vertices;
+	uint64_t edges;
+	uint64_t section_offset[SNAP_SECTIONS];
+	uint64_t section_size[SNAP_SECTIONS];
+	uint64_t file_size;
+	uint64_t payload_checksum;
+	uint64_t header_checksum;
+};
+
+/**
+ * SnapshotChecksum: 64 bit FNV style hash folded a word at a time
+ */
+inline uint64_t SnapshotChecksum(const char* p, size_t len, uint64_t h=1469598103934665603ULL)
+{
+	const uint64_t prime = 1099511628211ULL;
+	size_t words = len/8;
+	for (size_t i=0; i<words; ++i) {
+		uint64_t w;
+		memcpy(&w, p+i*8, 8);
+		h = (h ^ w) * prime;
+		h ^= h >> 29;
+	}
+	for (size_t i=words*8; i<len; ++i)
+		h = (h ^ (unsigned char)p[i]) * prime;
+	return h;
+}
+
+/**
+ * GraphSnapshot: writes a built graph and coordinates to a versioned binary
+ *                file, and opens one read only via mmap. Arrays are used in
+ *                place, several processes opening the same file share the
+ *                page cache copy.
+ */
+class GraphSnapshot {
+public:
+	/**
+	 * Open: map and validate a snapshot, the csr structure and every id are
+	 *       always checked, verify=true also checks the payload checksum
+	 */
+	GraphSnapshot(const char* File, bool verify) : map_(new MappedFile(File)) {
+		if (map_->size() < sizeof(SnapshotHeader))
+			throw local_exception("Snapshot too small");
+		memcpy(&head_, map_->data(), sizeof(SnapshotHeader));
+		if (memcmp(head_.magic, SNAPSHOT_MAGIC, 8))
+			throw local_exception("Snapshot bad magic");
+		if (head_.version != SNAPSHOT_VERSION)
+			throw local_exception("Snapshot version Mismatch");
+		if (head_.endian != SNAPSHOT_ENDIAN)
+			throw local_exception("Snapshot endian Mismatch");
+		SnapshotHeader h = head_;
+		h.header_checksum = 0;
+		if (SnapshotChecksum((const char*)&h, sizeof(h)) != head_.header_checksum)
+			throw local_exception("Snapshot header checksum Mismatch");
+		if (head_.file_size != map_->size())
+			throw local_exception("Snapshot size Mismatch");
+		for (size_t i=0; i<SNAP_SECTIONS; ++i) {
+			if (head_.section_offset[i] % SNAPSHOT_ALIGN
+			        || head_.section_offset[i] + head_.section_size[i] > head_.file_size)
+				throw local_exception("Snapshot section out of range");
+		}
+		Structure();
+		if (verify && Payload() != head_.payload_checksum)
+			throw local_exception("Snapshot payload checksum Mismatch");
+		map_->Advise(MADV_RANDOM);
+	}
+	size_t Vertices() const {
+		return head_.vertices;
+	}
+	size_t Edges() const {
+		return head_.edges;
+	}
+	/** Has: section s is not empty */
+	bool Has(snapshot_section s) const {
+		return head_.section_size[s] != 0;
+	}
+	template <typename T>
+	const T* Section(snapshot_section s, size_t count) const {
+		if (head_.section_size[s] != count*sizeof(T))
+			throw local_exception("Snapshot section size Mismatch");
+		return count ? reinterpret_cast<const T*>(map_->data()+head_.section_offset[s]) : 0;
+	}
+	/**
+	 * Attach: point a tway_csr_graph at the mapped arrays
+	 */
+	template <typename GraphT>
+	void Attach(GraphT& g) const {
+		typedef typename GraphT::vertex_descriptor V;
+		typedef typename GraphT::weight_type W;
+		typedef typename GraphT::edge_index_type E;
+		size_t n=Vertices(), m=Edges();
+		g.attach(n, m,
+		         Section<E>(SNAP_OFFSETS,n+1), Section<V>(SNAP_TARGETS,m),
+		         Section<W>(SNAP_WEIGHTS,m), Section<E>(SNAP_REV_OFFSETS,n+1),
+		         Section<V>(SNAP_REV_SOURCES,m), Section<E>(SNAP_REV_EDGES,m));
+	}
+	/**
+	 * Write: store graph g, n coordinates and the external id of every vertex
+	 *        when renumbered (order may be null), written to File.tmp then
+	 *        renamed
+	 */
+	template <typename GraphT, typename NodeT>
+	static void Write(const char* File, const GraphT& g, const NodeT* nodes, const U_INT* order=0) {
+		typedef typename GraphT::vertex_descriptor V;
+		typedef typename GraphT::weight_type W;
+		typedef typename GraphT::edge_index_type E;
+		size_t n=num_vertices(g), m=num_edges(g);
+		if (!n) throw local_exception("Cannot write empty Snapshot");
+		SnapshotHeader h;
+		memset(&h, 0, sizeof(h));
+		memcpy(h.magic, SNAPSHOT_MAGIC, 8);
+		h.version = SNAPSHOT_VERSION;
+		h.endian = SNAPSHOT_ENDIAN;
+		h.vertices = n;
+		h.edges = m;
+		const char* data[SNAP_SECTIONS] = {
+			(const char*)g.offsets(), (const char*)g.targets(), (const char*)g.weights(),
+			(const char*)g.rev_offsets(), (const char*)g.rev_sources(), (const char*)g.rev_edges(),
+			(const char*)nodes, (const char*)order
+		};
+		h.section_size[SNAP_OFFSETS] = (n+1)*sizeof(E);
+		h.section_size[SNAP_TARGETS] = m*sizeof(V);
+		h.section_size[SNAP_WEIGHTS] = m*sizeof(W);
+		h.section_size[SNAP_REV_OFFSETS] = (n+1)*sizeof(E);
+		h.section_size[SNAP_REV_SOURCES] = m*sizeof(V);
+		h.section_size[SNAP_REV_EDGES] = m*sizeof(E);
+		h.section_size[SNAP_COORDS] = n*sizeof(NodeT);
+		h.section_size[SNAP_ORDER] = (order) ? n*sizeof(U_INT) : 0;
+		uint64_t pos = Align(sizeof(SnapshotHeader));
+		h.payload_checksum = 1469598103934665603ULL;
+		for (size_t i=0; i<SNAP_SECTIONS; ++i) {
+			h.section_offset[i] = pos;
+			pos = Align(pos + h.section_size[i]);
+			h.payload_checksum = SnapshotChecksum(data[i], h.section_size[i], h.payload_checksum);
+		}
+		h.file_size = pos;
+		h.header_checksum = 0;
+		h.header_checksum = SnapshotChecksum((const char*)&h, sizeof(h));
+
+		std::string tmp = std::string(File) + ".tmp";
+		std::ofstream out(tmp.c_str(), std::ios::binary | std::ios::trunc);
+		if (!out.is_open()) throw local_exception("Cannot Open Snapshot for write");
+		out.write((const char*)&h, sizeof(h));
+		Pad(out, sizeof(h));
+		for (size_t i=0; i<SNAP_SECTIONS; ++i) {
+			out.write(data[i], h.section_size[i]);
+			Pad(out, h.section_size[i]);
+		}
+		out.close();
+		if (!out) throw local_exception("Cannot write Snapshot");
+		if (rename(tmp.c_str(), File))
+			throw local_exception("Cannot rename Snapshot");
+	}
+private:
+	static uint64_t Align(uint64_t p) {
+		return (p + SNAPSHOT_ALIGN - 1) / SNAPSHOT_ALIGN * SNAPSHOT_ALIGN;
+	}
+	static void Pad(std::ofstream& out, uint64_t len) {
+		static const char zero[SNAPSHOT_ALIGN] = {0};
+		out.write(zero, Align(len)-len);
+	}
+	/**
+	 * Structure: dispatch the csr checks on the stored index widths
+	 */
+	void Structure() const {
+		size_t n=Vertices(), m=Edges();
+		size_t e = head_.section_size[SNAP_OFFSETS] / (n+1);
+		size_t v = (m) ? head_.section_size[SNAP_TARGETS] / m : sizeof(uint32_t);
+		if (e == 4 && v == 4) Structure<uint32_t, uint32_t>();
+		else if (e == 8 && v == 4) Structure<uint64_t, uint32_t>();
+		else if (e == 4 && v == 8) Structure<uint32_t, uint64_t>();
+		else if (e == 8 && v == 8) Structure<uint64_t, uint64_t>();
+		else throw local_exception("Snapshot section size Mismatch");
+		if (Has(SNAP_ORDER))
+			Ids(Section<U_INT>(SNAP_ORDER, n), n, n);
+	}
+	/**
+	 * Structure: offsets start at 0, never decrease and end at E, for the
+	 *            forward and reverse csr; vertex ids below V, edge ids below E
+	 */
+	template <typename E, typename V>
+	void Structure() const {
+		size_t n=Vertices(), m=Edges();
+		Offsets(Section<E>(SNAP_OFFSETS, n+1), n, m);
+		Offsets(Section<E>(SNAP_REV_OFFSETS, n+1), n, m);
+		Ids(Section<V>(SNAP_TARGETS, m), m, n);
+		Ids(Section<V>(SNAP_REV_SOURCES, m), m, n);
+		Ids(Section<E>(SNAP_REV_EDGES, m), m, m);
+	}
+	template <typename E>
+	static void Offsets(const E* off, size_t n, size_t m) {
+		if (off[0] != 0 || off[n] != m)
+			throw local_exception("Snapshot offsets Mismatch");
+		for (size_t i=0; i<n; ++i)
+			if (off[i+1] < off[i])
+				throw local_exception("Snapshot offsets Mismatch");
+	}
+	template <typename T>
+	static void Ids(const T* ids, size_t count, size_t limit) {
+		for (size_t i=0; i<count; ++i)
+			if (ids[i] >= limit)
+				throw local_exception("Snapshot id out of range");
+	}
+	uint64_t Payload() const {
+		uint64_t c = 1469598103934665603ULL;
+		for (size_t i=0; i<SNAP_SECTIONS; ++i)
+			c = SnapshotChecksum(map_->data()+head_.section_offset[i], head_.section_size[i], c);
+		return c;
+	}
+	boost::shared_ptr<MappedFile> map_;
+	SnapshotHeader head_;
+};
+} // namespace TestAstar
+#endif
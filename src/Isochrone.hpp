@@ -0,0 +1,150 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_ISOCHRONE_HPP_
+#define _TESTASTAR_ISOCHRONE_HPP_
+#include "Locals.hh"
+#include "OneToAll.hpp"
+#include "ChunkPool.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <boost/bind.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/tway_queue.hpp>
+
+/** sources an isochrone worker claims at a time */
+#define ISOCHRONE_CHUNK 16
+
+namespace TestAstar {
+
+/**
+ * isochrone_arc: arc from a reached vertex that ends past the budget,
+ *   inside is the fraction of its cost spent before the budget runs out
+ */
+struct isochrone_arc {
+	U_INT src;
+	U_INT trg;
+	float inside;
+};
+
+/**
+ * DijkstraBudget: vertices within budget of root in settle order and the
+ *   arcs leaving them past it. Arcs ending past the budget are never
+ *   queued, so the search stops as soon as the queue key would exceed it.
+ *   Distances live in the workspace, whose reset is O(1), so a workspace
+ *   kept per thread costs only the vertices touched per call.
+ */
+template <typename GraphType, typename WorkspaceType>
+void DijkstraBudget(const GraphType& g, U_INT root, U_INT budget, std::vector<U_INT>& reached,
+                    std::vector<isochrone_arc>& boundary, WorkspaceType& Work)
+{
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexT;
+	typedef boost::tway_dary_heap<VertexT, 4, typename WorkspaceType::distance_map_type,
+	        typename WorkspaceType::index_in_heap_map_type> QueueT;
+	typedef boost::color_traits<typename WorkspaceType::color_type> Color;
+	reached.clear();
+	boundary.clear();
+	if (root >= num_vertices(g)) return;
+	Work.reset(num_vertices(g), std::numeric_limits<U_INT>::max());
+	typename WorkspaceType::distance_map_type d = Work.distance_map();
+	typename WorkspaceType::color_map_type color = Work.color_map();
+	QueueT Q(Work.heap_storage(), d, Work.index_in_heap_map());
+	put(d, root, 0);
+	put(color, root, Color::gray());
+	Q.push(root);
+	while (!Q.empty()) {
+		VertexT u = Q.top();
+		Q.pop();
+		put(color, u, Color::black());
+		++Work.stats().settled;
+		reached.push_back(u);
+		U_INT du = get(d, u);
+		typename boost::graph_traits<GraphType>::out_edge_iterator ei, ei_end;
+		for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+			VertexT v = target(*ei, g);
+			U_INT w = get(g.weight_map(), *ei);
+			if ((uint64_t)du + w > budget) {
+				isochrone_arc a;
+				a.src = u;
+				a.trg = v;
+				a.inside = (float)(budget - du) / w;
+				boundary.push_back(a);
+				continue;
+			}
+			DijkstraRelax(v, du + w, d, color, Q);
+		}
+	}
+}
+
+/**
+ * Isochrone: reachable sets within one budget for many sources. The graph
+ *   answers each source (Reachable) with sorted vertex ids and the
+ *   boundary arcs, on a ChunkPool of ISOCHRONE_CHUNK sources.
+ */
+template <typename GraphType>
+class Isochrone {
+public:
+	typedef std::vector<U_INT> VecT;
+	typedef std::vector<isochrone_arc> ArcVecT;
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+
+	Isochrone(GraphType& g, size_t threads) : hGraph(g), hPool(threads, ISOCHRONE_CHUNK) {}
+	~Isochrone() {}
+
+	/**
+	 * Run: the reachable set of every source within budget, returns the
+	 *      vertices settled over all of them
+	 */
+	size_t Run(const VecT& sources, U_INT budget) {
+		hSources = &sources;
+		hBudget = budget;
+		hReached.assign(sources.size(), VecT());
+		hBoundary.assign(sources.size(), ArcVecT());
+		return hPool.Run(sources.size(), boost::bind(&Isochrone::Chunk, this, _1, _2, _3));
+	}
+	/** Reached: vertices within the budget of source i, ascending ids */
+	const VecT& Reached(size_t i) const {
+		return hReached[i];
+	}
+	/** Boundary: arcs leaving the reached set of source i past the budget */
+	const ArcVecT& Boundary(size_t i) const {
+		return hBoundary[i];
+	}
+	/**
+	 * Bitset: the reached set of source i as one bit per vertex id, 64
+	 *         ids to a word
+	 */
+	void Bitset(size_t i, std::vector<uint64_t>& bits) const {
+		bits.assign((hGraph.NumVertices() + 63) / 64, 0);
+		const VecT& r = hReached[i];
+		for (size_t j=0; j<r.size(); ++j)
+			bits[r[j] >> 6] |= (uint64_t)1 << (r[j] & 63);
+	}
+private:
+	/** Chunk: sources first..last, returns the vertices settled */
+	size_t Chunk(size_t first, size_t last, WorkspaceT& Work) {
+		size_t settled = 0;
+		for (size_t i=first; i<last; ++i) {
+			hGraph.Reachable((*hSources)[i], hBudget, hReached[i], hBoundary[i], Work);
+			settled += Work.stats().settled;
+		}
+		return settled;
+	}
+
+	GraphType& hGraph;
+	ChunkPool<WorkspaceT> hPool;
+	const VecT* hSources;
+	U_INT hBudget;
+	std::vector<VecT> hReached;
+	std::vector<ArcVecT> hBoundary;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,304 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_LANDMARKS_HPP_
+#define _TESTASTAR_LANDMARKS_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <boost/graph/tway_csr_graph.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+#include <boost/graph/tway_queue.hpp>
+#include <boost/graph/tway_astar_search.hpp>
+
+namespace TestAstar {
+
+/** landmark_selection: farthest picks spread out vertices, avoid picks vertices
+ *  in regions the current landmarks bound badly */
+enum landmark_selection { LANDMARK_FARTHEST, LANDMARK_AVOID };
+
+/**
+ * Landmarks: ALT preprocessing, distances from and to a few landmark
+ *   vertices give lower bounds by the triangle inequality.
+ *
+ * Table is vertex major, row v holds d(L,v) and d(v,L) for every landmark
+ * L side by side, so a heuristic call reads one contiguous row.
+ */
+class Landmarks {
+public:
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef boost::tway_search_workspace<VertexT, U_INT, boost::tway_color_type> WorkspaceT;
+	typedef boost::tway_indexed_heap<VertexT, WorkspaceT::distance_map_type, WorkspaceT::index_in_heap_map_type> QueueT;
+
+	Landmarks() : hVerts(0), hCount(0), hStride(0), hSeed(1), hDiameter(0) {}
+	~Landmarks() {}
+
+	/**
+	 * Build: select count landmarks and fill the distance table
+	 */
+	void Build(const GraphT& g, size_t count, landmark_selection method) {
+		hVerts = num_vertices(g);
+		hCount = 0;
+		hDiameter = 0;
+		hLandmarks.clear();
+		if (!hVerts || !count) return;
+		hStride = count * 2;
+		hTable.assign(hVerts * hStride, Infinity());
+		std::vector<U_INT> from, to, order;
+		std::vector<VertexT> pred;
+		while (hCount < count) {
+			VertexT l = (method == LANDMARK_AVOID) ? PickAvoid(g, from, order, pred) : PickFarthest(g, from);
+			if (l >= hVerts || std::find(hLandmarks.begin(), hLandmarks.end(), l) != hLandmarks.end())
+				break;
+			Sweep(g, l, true, from, 0, 0);
+			Sweep(g, l, false, to, 0, 0);
+			for (size_t v=0; v<hVerts; ++v) {
+				hTable[v*hStride + hCount*2] = from[v];
+				hTable[v*hStride + hCount*2 + 1] = to[v];
+				if (from[v] != Infinity()) hDiameter = std::max(hDiameter, from[v]);
+				if (to[v] != Infinity()) hDiameter = std::max(hDiameter, to[v]);
+			}
+			hLandmarks.push_back(l);
+			++hCount;
+		}
+		if (hCount < count) {
+			// fewer reachable picks than asked, compact rows to hCount
+			for (size_t v=0; v<hVerts; ++v)
+				for (size_t i=0; i<2*hCount; ++i)
+					hTable[v*2*hCount + i] = hTable[v*hStride + i];
+			hStride = 2*hCount;
+			hTable.resize(hVerts * hStride);
+		}
+	}
+	size_t Count() const {
+		return hCount;
+	}
+	const std::vector<VertexT>& Vertices() const {
+		return hLandmarks;
+	}
+	static U_INT Infinity() {
+		return std::numeric_limits<U_INT>::max();
+	}
+	/**
+	 * Diameter: largest finite table entry, no Bound exceeds it
+	 */
+	U_INT Diameter() const {
+		return hDiameter;
+	}
+	/**
+	 * Row: landmark distances of v, d(L_i,v) at 2i and d(v,L_i) at 2i+1
+	 */
+	const U_INT* Row(VertexT v) const {
+		return &hTable[v*hStride];
+	}
+	/**
+	 * Bound: lower bound on d(u,w) from rows of u and w
+	 */
+	U_INT Bound(const U_INT* u, const U_INT* w) const {
+		U_INT best = 0;
+		for (size_t i=0; i<2*hCount; i+=2) {
+			// d(L,w) - d(L,u)
+			if (w[i] != Infinity() && u[i] != Infinity() && w[i] > u[i] && w[i]-u[i] > best)
+				best = w[i]-u[i];
+			// d(u,L) - d(w,L)
+			if (u[i+1] != Infinity() && w[i+1] != Infinity() && u[i+1] > w[i+1] && u[i+1]-w[i+1] > best)
+				best = u[i+1]-w[i+1];
+		}
+		return best;
+	}
+
+private:
+	/**
+	 * Sweep: one to all dijkstra from root on out edges (fwd) or in edges,
+	 *        optionally recording settle order and predecessors
+	 */
+	void Sweep(const GraphT& g, VertexT root, bool fwd, std::vector<U_INT>& dist,
+	           std::vector<U_INT>* order, std::vector<VertexT>* pred) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		hWork.reset(hVerts, Infinity());
+		WorkspaceT::distance_map_type d = hWork.distance_map();
+		WorkspaceT::predecessor_map_type p = hWork.predecessor_map();
+		WorkspaceT::color_map_type color = hWork.color_map();
+		QueueT Q(hWork.heap_storage(), d, hWork.index_in_heap_map());
+		if (order) order->clear();
+		put(d, root, 0);
+		put(color, root, Color::gray());
+		Q.push(root);
+		while (!Q.empty()) {
+			VertexT u = Q.top();
+			Q.pop();
+			put(color, u, Color::black());
+			if (order) order->push_back(u);
+			U_INT du = get(d, u);
+			if (fwd) {
+				GraphT::out_edge_iterator ei, ei_end;
+				for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei)
+					Relax(target(*ei, g), u, du + get(g.weight_map(), *ei), d, p, color, Q);
+			} else {
+				GraphT::in_edge_iterator ei, ei_end;
+				for (boost::tie(ei, ei_end) = in_edges(u, g); ei != ei_end; ++ei)
+					Relax(source(*ei, g), u, du + get(g.weight_map(), *ei), d, p, color, Q);
+			}
+		}
+		dist.resize(hVerts);
+		if (pred) pred->resize(hVerts);
+		for (size_t v=0; v<hVerts; ++v) {
+			dist[v] = hWork.visited(v) ? get(d, v) : Infinity();
+			if (pred) (*pred)[v] = hWork.visited(v) ? get(p, v) : v;
+		}
+	}
+	void Relax(VertexT v, VertexT u, U_INT dv, WorkspaceT::distance_map_type& d,
+	           WorkspaceT::predecessor_map_type& p, WorkspaceT::color_map_type& color, QueueT& Q) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		if (get(color, v) == Color::white()) {
+			put(d, v, dv);
+			put(p, v, u);
+			put(color, v, Color::gray());
+			Q.push(v);
+		} else if (get(color, v) == Color::gray() && dv < get(d, v)) {
+			put(d, v, dv);
+			put(p, v, u);
+			Q.update(v);
+		}
+	}
+	/**
+	 * Root: pseudo random vertex with outgoing arcs, fixed seed so builds
+	 *       are repeatable
+	 */
+	VertexT Root(const GraphT& g) {
+		for (size_t tries=0; tries<hVerts; ++tries) {
+			hSeed = hSeed * 1103515245U + 12345U;
+			VertexT r = (hSeed >> 8) % hVerts;
+			if (out_degree(r, g)) return r;
+		}
+		return 0;
+	}
+	/**
+	 * PickFarthest: vertex maximizing the distance to the nearest landmark,
+	 *               the first one is the farthest from a random root
+	 */
+	VertexT PickFarthest(const GraphT& g, std::vector<U_INT>& from) {
+		if (!hCount) Sweep(g, Root(g), true, from, 0, 0);
+		VertexT best = hVerts;
+		U_INT best_d = 0;
+		for (size_t v=0; v<hVerts; ++v) {
+			U_INT d = Infinity();
+			if (!hCount) {
+				d = from[v];
+			} else {
+				const U_INT* r = Row(v);
+				for (size_t i=0; i<2*hCount; i+=2)
+					d = std::min(d, r[i]);
+			}
+			if (d != Infinity() && d > best_d) {
+				best_d = d;
+				best = v;
+			}
+		}
+		return best;
+	}
+	/**
+	 * PickAvoid: grow a shortest path tree from a random root, weigh each
+	 *            vertex by how much the current bound underestimates its
+	 *            distance, and descend the heaviest landmark free subtree
+	 *            to a leaf
+	 */
+	VertexT PickAvoid(const GraphT& g, std::vector<U_INT>& from, std::vector<U_INT>& order, std::vector<VertexT>& pred) {
+		VertexT r = Root(g);
+		Sweep(g, r, true, from, &order, &pred);
+		std::vector<unsigned long long> size(hVerts, 0);
+		std::vector<VertexT> heavy(hVerts, hVerts);
+		std::vector<bool> covered(hVerts, false);
+		for (size_t i=0; i<hLandmarks.size(); ++i) covered[hLandmarks[i]] = true;
+		const U_INT* rr = Row(r);
+		for (size_t i=order.size(); i-- > 0; ) {
+			VertexT v = order[i];
+			if (!covered[v]) {
+				U_INT lb = Bound(rr, Row(v));
+				size[v] += from[v] - std::min(lb, from[v]);
+			} else {
+				size[v] = 0;
+			}
+			VertexT p = pred[v];
+			if (p == v) continue;
+			if (covered[v]) covered[p] = true;
+			if (heavy[p] == hVerts || size[v] > size[heavy[p]]) heavy[p] = v;
+			size[p] += size[v];
+		}
+		VertexT best = hVerts;
+		for (size_t i=0; i<order.size(); ++i)
+			if (size[order[i]] && (best == hVerts || size[order[i]] > size[best])) best = order[i];
+		if (best == hVerts) return PickFarthest(g, from);
+		while (heavy[best] != hVerts && size[heavy[best]]) best = heavy[best];
+		return best;
+	}
+	size_t hVerts;
+	size_t hCount;
+	size_t hStride;
+	U_INT hSeed;
+	U_INT hDiameter;
+	std::vector<VertexT> hLandmarks;
+	std::vector<U_INT> hTable;
+	WorkspaceT hWork;
+};
+
+/**
+ * landmark_heuristic: ALT lower bound towards goal (to_goal, for h_f) or
+ *                     from goal (for h_r), goal row looked up once
+ */
+template<typename GraphType>
+struct landmark_heuristic : public boost::tway_astar_heuristic<GraphType, U_INT> {
+public:
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor vertex_descriptor;
+	landmark_heuristic(const Landmarks* lm, vertex_descriptor goal, bool to_goal)
+		: m_lm(lm), m_goal(lm->Row(goal)), m_to_goal(to_goal) {}
+	U_INT operator()(vertex_descriptor u) {
+		return (m_to_goal) ? m_lm->Bound(m_lm->Row(u), m_goal) : m_lm->Bound(m_goal, m_lm->Row(u));
+	}
+private:
+	const Landmarks* m_lm;
+	const U_INT* m_goal;
+	bool m_to_goal;
+};
+
+/**
+ * average_landmark_heuristic: p(u) = (Bound(u,t) - Bound(s,u) + D) / 2 for
+ *   the forward side and D - p(u) backwards, D the table diameter, each
+ *   shifted so both sides start at the same key. The sum of the two is
+ *   constant, so a shared queue orders both sides as one dijkstra on
+ *   reduced costs, as the best meeting rule requires.
+ */
+template<typename GraphType>
+struct average_landmark_heuristic : public boost::tway_astar_heuristic<GraphType, U_INT> {
+public:
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor vertex_descriptor;
+	average_landmark_heuristic(const Landmarks* lm, vertex_descriptor s, vertex_descriptor t, bool fwd)
+		: m_lm(lm), m_s(lm->Row(s)), m_t(lm->Row(t)), m_fwd(fwd), m_shift(0) {
+		long long d = (long long)lm->Diameter() - Half(m_s) - Half(m_t);
+		if (fwd && d > 0) m_shift = (U_INT)d;
+		if (!fwd && d < 0) m_shift = (U_INT)-d;
+	}
+	U_INT operator()(vertex_descriptor u) {
+		U_INT h = Half(m_lm->Row(u));
+		return m_shift + ((m_fwd) ? h : m_lm->Diameter() - h);
+	}
+private:
+	U_INT Half(const U_INT* u) const {
+		return (m_lm->Bound(u, m_t) + m_lm->Diameter() - m_lm->Bound(m_s, u)) / 2;
+	}
+	const Landmarks* m_lm;
+	const U_INT* m_s;
+	const U_INT* m_t;
+	bool m_fwd;
+	U_INT m_shift;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,72 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _MAPPED_FILE_HPP_
+#define _MAPPED_FILE_HPP_
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Locals.hh"
+
+namespace TestAstar {
+/**
+ * MappedFile: read only memory map of a whole file, unmapped on destruction
+ */
+class MappedFile {
+public:
+	MappedFile(const char* File) : data_(0), size_(0) {
+		int fd = open(File, O_RDONLY);
+		if (fd<0) throw local_exception("Cannot Open File for mmap");
+		struct stat st;
+		if (fstat(fd,&st)<0) {
+			close(fd);
+			throw local_exception("Cannot stat File for mmap");
+		}
+		size_ = st.st_size;
+		if (size_) {
+			void* p = mmap(0, size_, PROT_READ, MAP_SHARED, fd, 0);
+			if (p==MAP_FAILED) {
+				close(fd);
+				throw local_exception("Cannot mmap File");
+			}
+			data_ = static_cast<const char*>(p);
+			madvise(p, size_, MADV_SEQUENTIAL);
+		}
+		close(fd);
+	}
+	~MappedFile() {
+		if (data_) munmap(const_cast<char*>(data_), size_);
+	}
+	const char* data() const {
+		return data_;
+	}
+	const char* end() const {
+		return data_+size_;
+	}
+	size_t size() const {
+		return size_;
+	}
+	/**
+	 * Advise: page access hint for the mapping, e.g. MADV_RANDOM once
+	 *         a sequential scan is over
+	 */
+	void Advise(int advice) const {
+		if (data_) madvise(const_cast<char*>(data_), size_, advice);
+	}
+private:
+	MappedFile(const MappedFile&);
+	MappedFile& operator=(const MappedFile&);
+	const char* data_;
+	size_t size_;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,115 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_ONE_TO_ALL_HPP_
+#define _TESTASTAR_ONE_TO_ALL_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <limits>
+#include <boost/graph/graph_traits.hpp>
+#include <boost/graph/tway_queue.hpp>
+
+namespace TestAstar {
+
+/**
+ * DijkstraRelax: lower d[v] to dv, queueing v when first reached; d is a
+ *   plain array or a workspace distance map
+ */
+template <typename VertexT, typename DistanceMap, typename ColorMap, typename QueueT>
+inline void DijkstraRelax(VertexT v, U_INT dv, DistanceMap d, ColorMap color, QueueT& Q)
+{
+	typedef boost::color_traits<typename boost::property_traits<ColorMap>::value_type> Color;
+	if (dv >= get(d, v)) return;
+	put(d, v, dv);
+	if (get(color, v) == Color::white()) {
+		put(color, v, Color::gray());
+		Q.push(v);
+	} else {
+		Q.update(v);
+	}
+}
+
+/**
+ * DijkstraOneToAll: distances from root to every vertex, unreachable ones
+ *   Infinity. The heap is keyed on the caller's dist array itself, so there
+ *   is no copy out after the search, the workspace only keeps colors and
+ *   heap positions. With reverse the arcs are followed backwards, giving
+ *   the distances from every vertex to root.
+ */
+template <typename GraphType, typename WorkspaceType>
+void DijkstraOneToAll(const GraphType& g, U_INT root, std::vector<U_INT>& dist, WorkspaceType& Work,
+                      bool reverse=false)
+{
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexT;
+	typedef boost::tway_dary_heap<VertexT, 4, U_INT*, typename WorkspaceType::index_in_heap_map_type> QueueT;
+	typedef boost::color_traits<typename WorkspaceType::color_type> Color;
+	size_t n = num_vertices(g);
+	dist.assign(n, std::numeric_limits<U_INT>::max());
+	if (root >= n) return;
+	Work.reset(n, std::numeric_limits<U_INT>::max());
+	typename WorkspaceType::color_map_type color = Work.color_map();
+	U_INT* d = &dist[0];
+	QueueT Q(Work.heap_storage(), d, Work.index_in_heap_map());
+	d[root] = 0;
+	put(color, root, Color::gray());
+	Q.push(root);
+	while (!Q.empty()) {
+		VertexT u = Q.top();
+		Q.pop();
+		put(color, u, Color::black());
+		++Work.stats().settled;
+		U_INT du = d[u];
+		if (reverse) {
+			typename boost::graph_traits<GraphType>::in_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = in_edges(u, g); ei != ei_end; ++ei)
+				DijkstraRelax(source(*ei, g), du + get(g.weight_map(), *ei), d, color, Q);
+		} else {
+			typename boost::graph_traits<GraphType>::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei)
+				DijkstraRelax(target(*ei, g), du + get(g.weight_map(), *ei), d, color, Q);
+		}
+	}
+}
+
+/**
+ * OneToAll: full shortest path trees, one source at a time. The graph
+ *   answers OneToAll by a hierarchy sweep when it has one, else by
+ *   DijkstraOneToAll. Workspace and sweep buffer belong to this object, so
+ *   keep one per thread and reuse it and the dist array across sources.
+ */
+template <typename GraphType>
+class OneToAll {
+public:
+	typedef std::vector<U_INT> VecT;
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+
+	OneToAll(GraphType& g) : hGraph(g) {}
+	~OneToAll() {}
+
+	/**
+	 * Run: dist gets one entry per vertex, Infinity where source does not
+	 *      reach, returns the number of vertices reached
+	 */
+	size_t Run(U_INT source, VecT& dist) {
+		hGraph.OneToAll(source, dist, hLevel, hWork);
+		size_t reached = 0;
+		for (size_t v=0; v<dist.size(); ++v)
+			if (dist[v] != Infinity()) ++reached;
+		return reached;
+	}
+	static U_INT Infinity() {
+		return std::numeric_limits<U_INT>::max();
+	}
+private:
+	GraphType& hGraph;
+	WorkspaceT hWork;
+	VecT hLevel;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,191 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_PARALLEL_BUILD_HPP_
+#define _TESTASTAR_PARALLEL_BUILD_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+namespace TestAstar {
+
+/**
+ * ParallelCsr: the arrays of a tway_csr_graph built on several threads,
+ *   same layout and order as the serial assign.
+ *
+ * Vertices are split into one id range per thread. Each side is a stable
+ * counting sort in two levels: threads count their slice of the input per
+ * range, a prefix sum over (range, slice) gives every slice its place and
+ * the slices are scattered into range buckets in input order; then each
+ * thread sorts its own bucket by vertex with a local prefix sum, so no two
+ * threads ever write the same slot and no per vertex table is replicated.
+ */
+template <typename GraphType>
+class ParallelCsr {
+public:
+	typedef typename GraphType::arc_type ArcT;
+	typedef typename GraphType::vertex_descriptor VertexT;
+	typedef typename GraphType::edge_index_type EdgeT;
+	typedef typename GraphType::weight_type WeightT;
+
+	ParallelCsr(size_t threads) : hParts(std::max(threads, (size_t)1)), hN(0), hM(0), hArcs(0), hForward(true), hPhase(COUNT) {}
+	~ParallelCsr() {}
+
+	/**
+	 * Build: n vertices from arcs into g, arcs keep their input order
+	 *        within each vertex
+	 */
+	void Build(size_t n, const std::vector<ArcT>& arcs, GraphType& g) {
+		if (!n || hParts == 1) {
+			g.assign(n, arcs.begin(), arcs.end());
+			return;
+		}
+		hN = n;
+		hArcs = &arcs;
+		hM = arcs.size();
+		hLo.resize(hParts+1);
+		for (size_t r=0; r<=hParts; ++r)
+			hLo[r] = (r * n + hParts - 1) / hParts;
+		hOffsets.assign(n+1, 0);
+		hRevOffsets.assign(n+1, 0);
+		hTargets.resize(hM);
+		hWeights.resize(hM);
+		hSources.resize(hM);
+		hRevSources.resize(hM);
+		hRevEdges.resize(hM);
+		hFill.resize(n);
+		// forward: arcs by source
+		hForward = true;
+		hStaged.resize(hM);
+		Sort();
+		std::vector<ArcT>().swap(hStaged);
+		// reverse: forward edge ids by target
+		hForward = false;
+		hStagedEdges.resize(hM);
+		Sort();
+		std::vector<EdgeT>().swap(hStagedEdges);
+		std::vector<VertexT>().swap(hSources);
+		std::vector<EdgeT>().swap(hFill);
+		hOffsets[n] = hM;
+		hRevOffsets[n] = hM;
+		g.adopt(n, hOffsets, hTargets, hWeights, hRevOffsets, hRevSources, hRevEdges);
+		hArcs = 0;
+	}
+private:
+	enum phase_type { COUNT, SCATTER, LOCAL };
+
+	/** Sort: the three phases for the current side */
+	void Sort() {
+		hHist.assign(hParts * hParts, 0);
+		Run(COUNT);
+		hStart.assign(hParts+1, 0);
+		size_t pos = 0;
+		for (size_t r=0; r<hParts; ++r) {
+			hStart[r] = pos;
+			for (size_t c=0; c<hParts; ++c) {
+				size_t k = hHist[c*hParts+r];
+				hHist[c*hParts+r] = pos;
+				pos += k;
+			}
+		}
+		hStart[hParts] = pos;
+		Run(SCATTER);
+		Run(LOCAL);
+	}
+	void Run(phase_type phase) {
+		hPhase = phase;
+		boost::thread_group pool;
+		for (size_t i=1; i<hParts; ++i)
+			pool.create_thread(boost::bind(&ParallelCsr::Worker, this, i));
+		Worker(0);
+		pool.join_all();
+	}
+	inline size_t Range(VertexT v) const {
+		return (size_t)((uint64_t)v * hParts / hN);
+	}
+	inline VertexT Key(size_t i) const {
+		return (hForward) ? (*hArcs)[i].src : hTargets[i];
+	}
+	void Worker(size_t part) {
+		if (hPhase == LOCAL) {
+			if (hForward) LocalForward(part);
+			else LocalReverse(part);
+			return;
+		}
+		size_t first = part * hM / hParts, last = (part+1) * hM / hParts;
+		size_t* hist = &hHist[part*hParts];
+		if (hPhase == COUNT) {
+			for (size_t i=first; i<last; ++i)
+				++hist[Range(Key(i))];
+			return;
+		}
+		for (size_t i=first; i<last; ++i) {
+			size_t r = Range(Key(i));
+			if (hForward) hStaged[hist[r]++] = (*hArcs)[i];
+			else hStagedEdges[hist[r]++] = i;
+		}
+	}
+	/** Prefix: degree counts of a range to start offsets, pos is its first slot */
+	static void Prefix(EdgeT* offsets, EdgeT* fill, size_t lo, size_t hi, size_t pos) {
+		for (size_t v=lo; v<hi; ++v) {
+			EdgeT k = offsets[v];
+			offsets[v] = fill[v] = pos;
+			pos += k;
+		}
+	}
+	void LocalForward(size_t r) {
+		size_t lo = hLo[r], hi = hLo[r+1];
+		for (size_t i=hStart[r]; i<hStart[r+1]; ++i)
+			++hOffsets[hStaged[i].src];
+		Prefix(&hOffsets[0], &hFill[0], lo, hi, hStart[r]);
+		for (size_t i=hStart[r]; i<hStart[r+1]; ++i) {
+			const ArcT& a = hStaged[i];
+			EdgeT e = hFill[a.src]++;
+			hTargets[e] = a.trg;
+			hWeights[e] = a.weight;
+			hSources[e] = a.src;
+		}
+	}
+	void LocalReverse(size_t r) {
+		size_t lo = hLo[r], hi = hLo[r+1];
+		for (size_t i=hStart[r]; i<hStart[r+1]; ++i)
+			++hRevOffsets[hTargets[hStagedEdges[i]]];
+		Prefix(&hRevOffsets[0], &hFill[0], lo, hi, hStart[r]);
+		for (size_t i=hStart[r]; i<hStart[r+1]; ++i) {
+			EdgeT e = hStagedEdges[i];
+			EdgeT slot = hFill[hTargets[e]]++;
+			hRevSources[slot] = hSources[e];
+			hRevEdges[slot] = e;
+		}
+	}
+
+	size_t hParts;
+	size_t hN, hM;
+	const std::vector<ArcT>* hArcs;
+	bool hForward;
+	phase_type hPhase;
+	std::vector<size_t> hLo;
+	std::vector<size_t> hHist;
+	std::vector<size_t> hStart;
+	std::vector<ArcT> hStaged;
+	std::vector<EdgeT> hStagedEdges;
+	std::vector<EdgeT> hFill;
+	std::vector<VertexT> hSources;
+	std::vector<EdgeT> hOffsets;
+	std::vector<VertexT> hTargets;
+	std::vector<WeightT> hWeights;
+	std::vector<EdgeT> hRevOffsets;
+	std::vector<VertexT> hRevSources;
+	std::vector<EdgeT> hRevEdges;
+};
+} // namespace TestAstar
+#endif
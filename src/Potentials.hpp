@@ -0,0 +1,193 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_POTENTIALS_HPP_
+#define _TESTASTAR_POTENTIALS_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+#include <boost/graph/graph_traits.hpp>
+
+/** fixed point bits of the potential scale */
+#define POTENTIAL_SHIFT 16
+
+namespace TestAstar {
+
+/**
+ * Potentials: integer lower bounds on path cost from coordinates.
+ *
+ * Coordinates are kept as two flat arrays. The distance is the norm
+ * max(|dx|,|dy|) + 0.414 min(|dx|,|dy|), close to euclidean and integer
+ * only, and Build calibrates the scale as the smallest cost per unit of
+ * that norm over all edges, in fixed point. Scaled norms then never
+ * exceed a path cost and obey the triangle inequality, so the potential
+ * is admissible and consistent.
+ */
+class Potentials {
+public:
+	Potentials() : hScale(0), hLimit(0) {}
+	~Potentials() {}
+
+	/**
+	 * Build: copy coordinates and calibrate the scale, coords may be null
+	 *        which leaves all potentials 0
+	 */
+	template <typename GraphType, typename NodeType>
+	void Build(const GraphType& g, const NodeType* coords) {
+		size_t n = num_vertices(g);
+		hX.assign(n, 0);
+		hY.assign(n, 0);
+		hScale = 0;
+		hLimit = 0;
+		if (!coords) return;
+		for (size_t v=0; v<n; ++v) {
+			hX[v] = coords[v].x;
+			hY[v] = coords[v].y;
+		}
+		uint64_t best = std::numeric_limits<uint64_t>::max();
+		typename boost::graph_traits<GraphType>::out_edge_iterator ei, ei_end;
+		for (size_t v=0; v<n; ++v) {
+			for (boost::tie(ei, ei_end) = out_edges(v, g); ei != ei_end; ++ei) {
+				uint64_t d = Norm(v, target(*ei, g));
+				if (!d) continue;
+				uint64_t r = ((uint64_t)get(g.weight_map(), *ei) << POTENTIAL_SHIFT) / d;
+				if (r < best) best = r;
+			}
+		}
+		if (best == std::numeric_limits<uint64_t>::max()) return;
+		hScale = best;
+		if (hScale) hLimit = std::numeric_limits<uint64_t>::max() / hScale;
+	}
+	/**
+	 * Bound: lower bound on the cost between u and w, saturates at the
+	 *        U_INT maximum for pairs no U_INT path can join
+	 */
+	inline U_INT Bound(size_t u, size_t w) const {
+		if (!hScale) return 0;
+		uint64_t d = Norm(u, w);
+		if (d > hLimit) return std::numeric_limits<U_INT>::max();
+		uint64_t h = (d * hScale) >> POTENTIAL_SHIFT;
+		return (h < std::numeric_limits<U_INT>::max()) ? (U_INT)h : std::numeric_limits<U_INT>::max();
+	}
+	/**
+	 * Admits: cost on the arc u to w keeps the scale a lower bound, compared
+	 *         in fixed point since Bound rounds down
+	 */
+	inline bool Admits(size_t u, size_t w, U_INT cost) const {
+		if (!hScale) return true;
+		uint64_t d = Norm(u, w);
+		if (d > hLimit) return false;
+		return ((uint64_t)cost << POTENTIAL_SHIFT) >= hScale * d;
+	}
+	/**
+	 * Scale: calibrated cost per coordinate unit, 0 without coordinates
+	 */
+	double Scale() const {
+		return (double)hScale * 1024 / (1 << POTENTIAL_SHIFT);
+	}
+private:
+	/** Norm: 1024 max + 424 min of the coordinate differences */
+	inline uint64_t Norm(size_t u, size_t w) const {
+		int64_t dx = (int64_t)hX[u] - hX[w];
+		int64_t dy = (int64_t)hY[u] - hY[w];
+		uint64_t a = (dx < 0) ? -dx : dx;
+		uint64_t b = (dy < 0) ? -dy : dy;
+		return (a > b) ? (a << 10) + b*424 : (b << 10) + a*424;
+	}
+	std::vector<S_INT> hX;
+	std::vector<S_INT> hY;
+	uint64_t hScale;
+	uint64_t hLimit;
+};
+
+/**
+ * PotentialMemo: per query cache of potentials with one slot per vertex for
+ *   each of the two goals of a two way search, entries of an older query
+ *   read as empty so Reset is O(1)
+ */
+class PotentialMemo {
+public:
+	PotentialMemo() : hEpoch(0) {}
+	void Reset(size_t n) {
+		if (n != hEntry.size()) {
+			hEntry.assign(n, entry());
+			hEpoch = 1;
+			return;
+		}
+		if (++hEpoch == 0) {
+			for (size_t i=0; i<hEntry.size(); ++i)
+				hEntry[i].stamp[0] = hEntry[i].stamp[1] = 0;
+			hEpoch = 1;
+		}
+	}
+	inline bool Find(size_t v, size_t side, U_INT& val) const {
+		const entry& e = hEntry[v];
+		if (e.stamp[side] != hEpoch) return false;
+		val = e.val[side];
+		return true;
+	}
+	inline void Store(size_t v, size_t side, U_INT val) {
+		entry& e = hEntry[v];
+		e.stamp[side] = hEpoch;
+		e.val[side] = val;
+	}
+private:
+	struct entry {
+		entry() {
+			stamp[0] = stamp[1] = 0;
+		}
+		uint32_t stamp[2];
+		U_INT val[2];
+	};
+	std::vector<entry> hEntry;
+	uint32_t hEpoch;
+};
+
+/**
+ * PotentialWorkspace: search workspace with a potential memo, one per thread
+ */
+template <typename BaseType>
+class PotentialWorkspace : public BaseType {
+public:
+	PotentialMemo& memo() {
+		return hMemo;
+	}
+private:
+	PotentialMemo hMemo;
+};
+
+/**
+ * potential_heuristic: Potentials bound towards goal, memo and side given
+ *   caches values for this query
+ */
+template<typename GraphType>
+struct potential_heuristic {
+public:
+	typedef typename boost::graph_traits<GraphType>::vertex_descriptor vertex_descriptor;
+	potential_heuristic(const Potentials* p, vertex_descriptor goal, PotentialMemo* memo=0, size_t side=0)
+		: m_p(p), m_goal(goal), m_memo(memo), m_side(side) {}
+	inline U_INT operator()(vertex_descriptor u) {
+		if (!m_memo) return m_p->Bound(u, m_goal);
+		U_INT h;
+		if (!m_memo->Find(u, m_side, h)) {
+			h = m_p->Bound(u, m_goal);
+			m_memo->Store(u, m_side, h);
+		}
+		return h;
+	}
+private:
+	const Potentials* m_p;
+	vertex_descriptor m_goal;
+	PotentialMemo* m_memo;
+	size_t m_side;
+};
+} // namespace TestAstar
+#endif
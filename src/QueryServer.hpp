@@ -0,0 +1,275 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_QUERY_SERVER_HPP_
+#define _TESTASTAR_QUERY_SERVER_HPP_
+#include "Locals.hh"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <algorithm>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+
+#define SERVER_BACKLOG 64
+#define SERVER_READ    65536
+#define SERVER_NEAREST 1024
+
+namespace TestAstar {
+
+/**
+ * QueryServer: answers queries on a local socket until told to shut down.
+ *
+ * ADDR is a path for a UNIX socket, PORT or HOST:PORT for TCP, PORT alone
+ * binds the loopback address. The protocol is one request per line and one
+ * response line per request in the same order, so a client may pipeline
+ * any number of requests before reading:
+ *   d SRC TRG   -> OK COST            cost only
+ *   q SRC TRG   -> OK COST N V1 .. VN cost and path
+ *   x X1 Y1 X2 Y2 -> as q             ends snapped from positions
+ *   n X Y [K]   -> OK N V1 .. VN      the K (default 1) nearest vertices
+ *   u SRC TRG C -> OK                 new cost C of the arcs SRC to TRG
+ *   shutdown    -> OK                 stop the server
+ *   quit                              close this connection
+ * a failed search answers FAIL, a bad line ERR and a reason.
+ *
+ * A pool of workers shares the graph read only, each owns a workspace and
+ * serves one connection at a time, answering every complete line of a read
+ * and sending the responses in one write. Consecutive u lines are applied
+ * as one weight update once the run ends, searches in flight keep the
+ * weights they started with.
+ */
+template <typename GraphType>
+class QueryServer {
+public:
+	typedef typename GraphType::WorkspaceT WorkspaceT;
+	typedef std::vector<typename GraphType::GraphT::arc_type> BatchT;
+
+	QueryServer(GraphType& g, size_t threads)
+		: hGraph(g), hThreads(std::max(threads, (size_t)1)), hListen(-1), hStop(false) {}
+	~QueryServer() {
+		if (hListen >= 0) close(hListen);
+		if (!hPath.empty()) unlink(hPath.c_str());
+	}
+
+	/**
+	 * Listen: bind and listen on addr
+	 */
+	void Listen(const char* addr) {
+		std::string a(addr);
+		size_t colon = a.rfind(':');
+		bool tcp = (a.find('/') == std::string::npos)
+		           && (a.find_first_not_of("0123456789", (colon == std::string::npos) ? 0 : colon+1) == std::string::npos);
+		if (tcp) {
+			struct sockaddr_in in;
+			memset(&in, 0, sizeof(in));
+			in.sin_family = AF_INET;
+			in.sin_port = htons(atoi(a.c_str() + ((colon == std::string::npos) ? 0 : colon+1)));
+			std::string host = (colon == std::string::npos) ? std::string("127.0.0.1") : a.substr(0, colon);
+			if (inet_pton(AF_INET, host.c_str(), &in.sin_addr) != 1)
+				throw local_exception("Server bad address");
+			hListen = socket(AF_INET, SOCK_STREAM, 0);
+			if (hListen < 0) throw local_exception("Server cannot create socket");
+			int on = 1;
+			setsockopt(hListen, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+			if (bind(hListen, (struct sockaddr*)&in, sizeof(in)))
+				throw local_exception("Server cannot bind");
+		} else {
+			struct sockaddr_un un;
+			memset(&un, 0, sizeof(un));
+			un.sun_family = AF_UNIX;
+			if (a.size() >= sizeof(un.sun_path))
+				throw local_exception("Server socket path too long");
+			strcpy(un.sun_path, a.c_str());
+			hListen = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (hListen < 0) throw local_exception("Server cannot create socket");
+			unlink(a.c_str());
+			if (bind(hListen, (struct sockaddr*)&un, sizeof(un)))
+				throw local_exception("Server cannot bind");
+			hPath = a;
+		}
+		if (listen(hListen, SERVER_BACKLOG))
+			throw local_exception("Server cannot listen");
+	}
+	/**
+	 * Serve: run the worker pool until a shutdown request
+	 */
+	void Serve() {
+		signal(SIGPIPE, SIG_IGN);
+		boost::thread_group pool;
+		for (size_t i=0; i<hThreads; ++i)
+			pool.create_thread(boost::bind(&QueryServer::Worker, this));
+		pool.join_all();
+	}
+private:
+	void Worker() {
+		WorkspaceT Work;
+		while (!hStop) {
+			int fd = accept(hListen, 0, 0);
+			if (fd < 0) {
+				if (errno == EINTR || errno == ECONNABORTED) continue;
+				break;
+			}
+			Connection(fd, Work);
+			close(fd);
+		}
+	}
+	/**
+	 * Connection: answer lines until the peer closes, quits or shuts down
+	 */
+	void Connection(int fd, WorkspaceT& Work) {
+		std::string in, out;
+		std::vector<U_INT> vlist;
+		BatchT batch;
+		char buf[SERVER_READ];
+		bool open = true;
+		while (open && !hStop) {
+			ssize_t got = read(fd, buf, sizeof(buf));
+			if (got < 0 && errno == EINTR) continue;
+			if (got <= 0) break;
+			in.append(buf, got);
+			size_t start = 0, end;
+			while (open && (end = in.find('\n', start)) != std::string::npos) {
+				open = Answer(in.substr(start, end-start), out, vlist, batch, Work);
+				start = end+1;
+			}
+			Update(out, batch);
+			in.erase(0, start);
+			if (!Send(fd, out)) break;
+			out.clear();
+		}
+	}
+	/**
+	 * Answer: append the response to one request line, false ends the
+	 *         connection
+	 */
+	bool Answer(const std::string& line, std::string& out, std::vector<U_INT>& vlist, BatchT& batch, WorkspaceT& Work) {
+		char cmd[16];
+		long a[4] = {0, 0, 0, 0};
+		int n = sscanf(line.c_str(), "%15s %ld %ld %ld %ld", cmd, &a[0], &a[1], &a[2], &a[3]);
+		if (n <= 0) return true;
+		if (!strcmp(cmd, "u") && n == 4) {
+			const char* why = hGraph.CheckUpdate(a[0], a[1], a[2]);
+			if (!why) {
+				batch.push_back(typename BatchT::value_type(a[0], a[1], a[2]));
+				return true;
+			}
+			Update(out, batch);
+			out += "ERR ";
+			out += why;
+			out += "\n";
+			return true;
+		}
+		Update(out, batch);
+		if (!strcmp(cmd, "quit")) return false;
+		if (!strcmp(cmd, "shutdown")) {
+			out += "OK\n";
+			hStop = true;
+			shutdown(hListen, SHUT_RDWR);
+			return false;
+		}
+		bool snap = !strcmp(cmd, "x"), path = snap || !strcmp(cmd, "q");
+		if (!strcmp(cmd, "n") && (n == 3 || n == 4))
+			return Nearest(a[0], a[1], (n == 4) ? a[2] : 1, out, vlist);
+		if ((!path && strcmp(cmd, "d")) || n < 3 || (snap && n != 5)) {
+			out += "ERR bad request\n";
+			return true;
+		}
+		U_INT cost = 0;
+		bool found = false;
+		try {
+			U_INT src = (snap) ? hGraph.Snap(a[0], a[1]) : (U_INT)a[0];
+			U_INT trg = (snap) ? hGraph.Snap(a[2], a[3]) : (U_INT)a[1];
+			found = hGraph.Search(src, trg, vlist, cost, Work);
+		} catch (local_exception& e) {
+			out += "ERR ";
+			out += e.what();
+			out += "\n";
+			return true;
+		}
+		if (!found) {
+			out += "FAIL\n";
+			return true;
+		}
+		char num[32];
+		snprintf(num, sizeof(num), "OK %u", (unsigned)cost);
+		out += num;
+		if (path) {
+			snprintf(num, sizeof(num), " %u", (unsigned)vlist.size());
+			out += num;
+			for (std::vector<U_INT>::const_iterator it=vlist.begin(); it!=vlist.end(); ++it) {
+				snprintf(num, sizeof(num), " %u", (unsigned)*it);
+				out += num;
+			}
+		}
+		out += "\n";
+		return true;
+	}
+	/**
+	 * Nearest: answer an n line, k is capped at SERVER_NEAREST
+	 */
+	bool Nearest(long x, long y, long k, std::string& out, std::vector<U_INT>& vlist) {
+		if (k < 1 || k > SERVER_NEAREST) {
+			out += "ERR bad request\n";
+			return true;
+		}
+		char num[32];
+		snprintf(num, sizeof(num), "OK %u", (unsigned)hGraph.Nearest(x, y, k, vlist));
+		out += num;
+		for (std::vector<U_INT>::const_iterator it=vlist.begin(); it!=vlist.end(); ++it) {
+			snprintf(num, sizeof(num), " %u", (unsigned)*it);
+			out += num;
+		}
+		out += "\n";
+		return true;
+	}
+	/**
+	 * Update: apply the pending u lines as one batch and answer each
+	 */
+	void Update(std::string& out, BatchT& batch) {
+		if (batch.empty()) return;
+		const char* reply = "OK\n";
+		try {
+			hGraph.UpdateWeights(batch);
+		} catch (local_exception&) {
+			reply = "ERR update failed\n";
+		}
+		for (size_t i=0; i<batch.size(); ++i)
+			out += reply;
+		batch.clear();
+	}
+	static bool Send(int fd, const std::string& out) {
+		size_t done = 0;
+		while (done < out.size()) {
+			ssize_t put = write(fd, out.data()+done, out.size()-done);
+			if (put < 0 && errno == EINTR) continue;
+			if (put <= 0) return false;
+			done += put;
+		}
+		return true;
+	}
+
+	GraphType& hGraph;
+	size_t hThreads;
+	int hListen;
+	std::string hPath;
+	volatile bool hStop;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,238 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_REACH_BOUNDS_HPP_
+#define _TESTASTAR_REACH_BOUNDS_HPP_
+#include "Locals.hh"
+#include "Potentials.hpp"
+#include "Landmarks.hpp"
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdint.h>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
+#include <boost/graph/tway_csr_graph.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+#include <boost/graph/tway_queue.hpp>
+
+namespace TestAstar {
+
+/**
+ * ReachBounds: upper bounds on the reach of every vertex, the largest
+ *   min(d(s,v), d(v,t)) over shortest paths s..v..t.
+ *
+ * Reach is exact below a limit L and unbounded above it. Every shortest
+ * path proving reach r(v) >= x has a subpath s'..v..t' that still proves
+ * it with d(s',v) and d(v,t') below x plus the longest arc, so a sweep from
+ * every vertex out to 2L plus twice the longest arc sees a proof of either
+ * the exact reach or of L. Each sweep takes min(depth, height) of its
+ * vertices over the tight arcs. Bounds are kept as 16 bit multiples of
+ * L / 65534 rounded up, all ones for unbounded.
+ */
+class ReachBounds {
+public:
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef boost::tway_search_workspace<VertexT, U_INT, boost::tway_color_type> WorkspaceT;
+	typedef boost::tway_dary_heap<VertexT, 4, WorkspaceT::distance_map_type, WorkspaceT::index_in_heap_map_type> QueueT;
+	typedef uint16_t reach_type;
+
+	ReachBounds() : hUnit(1), hLimit(0), hRadius(0), hZero(false), hGraph(0) {}
+	~ReachBounds() {}
+
+	/**
+	 * Build: bounds below limit on threads, 0 threads is one per core
+	 */
+	void Build(const GraphT& g, U_INT limit, size_t threads) {
+		size_t n = num_vertices(g);
+		hReach.assign(n, Unbounded());
+		hLimit = limit;
+		hUnit = std::max((U_INT)1, (U_INT)((limit + 65533) / 65534));
+		if (!n || !limit) return;
+		U_INT longest = 0;
+		hZero = false;
+		for (size_t e=0; e<num_edges(g); ++e) {
+			longest = std::max(longest, g.weight(e));
+			if (!g.weight(e)) hZero = true;
+		}
+		uint64_t radius = 2 * (uint64_t)limit + 2 * (uint64_t)longest;
+		hRadius = (U_INT)std::min(radius, (uint64_t)std::numeric_limits<U_INT>::max() / 2);
+		if (!threads) threads = boost::thread::hardware_concurrency();
+		threads = std::max((size_t)1, std::min(threads, n));
+		hGraph = &g;
+		hPart.assign(threads, std::vector<U_INT>());
+		boost::thread_group pool;
+		for (size_t i=1; i<threads; ++i)
+			pool.create_thread(boost::bind(&ReachBounds::Worker, this, i, threads));
+		Worker(0, threads);
+		pool.join_all();
+		hGraph = 0;
+		for (size_t v=0; v<n; ++v) {
+			U_INT r = 0;
+			for (size_t i=0; i<threads; ++i) r = std::max(r, hPart[i][v]);
+			if (r < limit) hReach[v] = (reach_type)((r + hUnit - 1) / hUnit);
+		}
+		std::vector<std::vector<U_INT> >().swap(hPart);
+	}
+	/**
+	 * Reach: bound on the reach of v, Infinity if unbounded
+	 */
+	inline U_INT Reach(VertexT v) const {
+		reach_type r = hReach[v];
+		return (r == Unbounded()) ? Infinity() : (U_INT)r * hUnit;
+	}
+	/**
+	 * Bounded: vertices with a finite bound, the ones a search may prune
+	 */
+	size_t Bounded() const {
+		size_t k = 0;
+		for (size_t v=0; v<hReach.size(); ++v)
+			if (hReach[v] != Unbounded()) ++k;
+		return k;
+	}
+	size_t Bytes() const {
+		return hReach.size() * sizeof(reach_type);
+	}
+	static U_INT Infinity() {
+		return std::numeric_limits<U_INT>::max();
+	}
+private:
+	static reach_type Unbounded() {
+		return std::numeric_limits<reach_type>::max();
+	}
+	void Worker(size_t part, size_t parts) {
+		WorkspaceT Work;
+		std::vector<VertexT> order;
+		std::vector<U_INT>& best = hPart[part];
+		best.assign(num_vertices(*hGraph), 0);
+		for (size_t s=part; s<best.size(); s+=parts)
+			Sweep(s, best, order, Work);
+	}
+	/**
+	 * Sweep: dijkstra from s out to the radius, then heights over the tight
+	 *        arcs in reverse settle order, repeated while zero weight arcs
+	 *        still raise one
+	 */
+	void Sweep(VertexT s, std::vector<U_INT>& best, std::vector<VertexT>& order, WorkspaceT& Work) {
+		typedef boost::color_traits<boost::tway_color_type> Color;
+		const GraphT& g = *hGraph;
+		Work.reset(num_vertices(g), Infinity());
+		WorkspaceT::distance_map_type d = Work.distance_map();
+		WorkspaceT::cost_map_type height = Work.cost_map();
+		WorkspaceT::color_map_type color = Work.color_map();
+		QueueT Q(Work.heap_storage(), d, Work.index_in_heap_map());
+		order.clear();
+		put(d, s, 0);
+		put(color, s, Color::gray());
+		Q.push(s);
+		while (!Q.empty()) {
+			VertexT u = Q.top();
+			Q.pop();
+			U_INT du = get(d, u);
+			if (du > hRadius) break;
+			put(color, u, Color::black());
+			put(height, u, 0);
+			order.push_back(u);
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+				VertexT v = target(*ei, g);
+				U_INT dv = du + get(g.weight_map(), *ei);
+				if (get(color, v) == Color::white()) {
+					put(d, v, dv);
+					put(color, v, Color::gray());
+					Q.push(v);
+				} else if (get(color, v) == Color::gray() && dv < get(d, v)) {
+					put(d, v, dv);
+					Q.update(v);
+				}
+			}
+		}
+		for (bool raised = true; raised; ) {
+			raised = false;
+			for (size_t i=order.size(); i-- > 0; ) {
+				VertexT u = order[i];
+				U_INT du = get(d, u), hu = get(height, u);
+				GraphT::out_edge_iterator ei, ei_end;
+				for (boost::tie(ei, ei_end) = out_edges(u, g); ei != ei_end; ++ei) {
+					VertexT v = target(*ei, g);
+					U_INT w = get(g.weight_map(), *ei);
+					if (get(color, v) == Color::black() && get(d, v) == du + w && get(height, v) + w > hu) {
+						hu = get(height, v) + w;
+						raised = true;
+					}
+				}
+				put(height, u, hu);
+			}
+			if (!hZero) break;
+		}
+		for (size_t i=0; i<order.size(); ++i) {
+			VertexT u = order[i];
+			best[u] = std::max(best[u], std::min(get(d, u), get(height, u)));
+		}
+	}
+
+	std::vector<reach_type> hReach;
+	U_INT hUnit;
+	U_INT hLimit;
+	U_INT hRadius;
+	bool hZero;
+	const GraphT* hGraph;
+	std::vector<std::vector<U_INT> > hPart;
+};
+
+/**
+ * reach_lower_bound: admissible cost between two vertices, the larger of
+ *   the coordinate and the landmark bounds
+ */
+struct reach_lower_bound {
+	reach_lower_bound(const Potentials* pot, const Landmarks* lm) : m_pot(pot), m_lm(lm) {}
+	U_INT operator()(size_t u, size_t w) const {
+		U_INT b = m_pot->Bound(u, w);
+		if (m_lm && m_lm->Count()) b = std::max(b, m_lm->Bound(m_lm->Row(u), m_lm->Row(w)));
+		return b;
+	}
+private:
+	const Potentials* m_pot;
+	const Landmarks* m_lm;
+};
+
+/**
+ * reach_filter: edge filter for the tway searches, drops the label an edge
+ *   would give v when reach(v) is below both the label and the lower bound
+ *   from v to the other end of the query, after the base filter; a null
+ *   reach keeps what the base keeps. Labels are read from d_f forward and
+ *   d_r backward, the same map when both sides share one set of labels
+ */
+template <typename BaseFilter, typename DistanceMap, typename WeightMap, typename LowerBound>
+struct reach_filter {
+	reach_filter(BaseFilter base, const ReachBounds* reach, DistanceMap d_f, DistanceMap d_r, WeightMap w,
+	             LowerBound lb, size_t s, size_t t)
+		: m_base(base), m_reach(reach), m_d_f(d_f), m_d_r(d_r), m_w(w), m_lb(lb), m_s(s), m_t(t) {}
+	template <class Edge>
+	bool operator()(const Edge& e, bool is_fwd) const {
+		if (!m_base(e, is_fwd)) return false;
+		if (!m_reach) return true;
+		size_t u = (is_fwd) ? e.src : e.trg, v = (is_fwd) ? e.trg : e.src;
+		U_INT r = m_reach->Reach(v);
+		if (r == ReachBounds::Infinity() || r >= get((is_fwd) ? m_d_f : m_d_r, u) + get(m_w, e)) return true;
+		return r >= ((is_fwd) ? m_lb(v, m_t) : m_lb(m_s, v));
+	}
+private:
+	BaseFilter m_base;
+	const ReachBounds* m_reach;
+	DistanceMap m_d_f;
+	DistanceMap m_d_r;
+	WeightMap m_w;
+	LowerBound m_lb;
+	size_t m_s;
+	size_t m_t;
+};
+} // namespace TestAstar
+#endif
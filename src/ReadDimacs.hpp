@@ -15,10 +15,14 @@
 #include <fstream>
 #include <string>
 #include <vector>
+#include <algorithm>
 #include <boost/tokenizer.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
 #include "Locals.hh"
+#include "MappedFile.hpp"
 
 namespace TestAstar {
 class ReadDimacs {
@@ -26,27 +30,101 @@ public:
 	typedef boost::function<void (U_INT,U_INT,S_INT)> Graph_ExtrT;
 	typedef boost::function<void (U_INT,S_INT,S_INT)> Coords_ExtrT;
 	typedef boost::function<void (U_INT,U_INT)> Probpp_ExtrT;
-	enum data_type { GRAPH_DATA, COORDS_DATA, PROBPP_DATA, ERROR_DATA };
-	ReadDimacs() : nodes(0),arcs(0),probpp(0) {}
+	typedef boost::function<void (U_INT)> Vertex_ExtrT;
+	typedef boost::function<void (S_INT,S_INT,S_INT,S_INT)> Coordpp_ExtrT;
+	enum data_type { GRAPH_DATA, COORDS_DATA, PROBPP_DATA, PROBMM_DATA, UPDATE_DATA, ERROR_DATA };
+	ReadDimacs() : nodes(0),arcs(0),probpp(0),mm_sources(0),mm_targets(0),updates(0),use_mmap(false) {}
 	~ReadDimacs() {}
 	void Process_Graph_File(const char* File, Graph_ExtrT fn) {
-		ReadFile(File,fn,NULL,NULL);
+		Read(File,fn,NULL,NULL);
 	}
 	void Process_Coords_File(const char* File, Coords_ExtrT fn) {
-		ReadFile(File,NULL,fn,NULL);
+		Read(File,NULL,fn,NULL);
 	}
-	void Process_P2P_Problem_File(const char* File, Probpp_ExtrT fn) {
-		ReadFile(File,NULL,NULL,fn);
+	/**
+	 * Process_P2P_Problem_File: "q SRC TRG" lines, and with coord_fn also
+	 *   "x X1 Y1 X2 Y2" lines giving the two ends as positions to snap
+	 */
+	void Process_P2P_Problem_File(const char* File, Probpp_ExtrT fn, Coordpp_ExtrT coord_fn=NULL) {
+		Read(File,NULL,NULL,fn,NULL,NULL,NULL,coord_fn);
+	}
+	/**
+	 * Process_M2M_Problem_File: many to many problem, header
+	 *   "p aux sp m2m SOURCES TARGETS" then "s ID" and "t ID" lines
+	 */
+	void Process_M2M_Problem_File(const char* File, Vertex_ExtrT source_fn, Vertex_ExtrT target_fn) {
+		Read(File,NULL,NULL,NULL,source_fn,target_fn);
+	}
+	/**
+	 * Process_Update_File: weight updates, header "p aux sp upd COUNT" then
+	 *   "a SRC TRG COST" lines giving the new cost of the arcs SRC to TRG
+	 */
+	void Process_Update_File(const char* File, Graph_ExtrT fn) {
+		Read(File,NULL,NULL,NULL,NULL,NULL,fn);
 	}
 	void Process_Multiple(const char* File, Graph_ExtrT graph_fn, Coords_ExtrT coords_fn, Probpp_ExtrT probpp_fn) {
-		ReadFile(File,graph_fn, coords_fn, probpp_fn);
+		Read(File,graph_fn, coords_fn, probpp_fn);
+	}
+	/**
+	 * Process_Graph_Parallel: the graph file mapped and split into newline
+	 *   aligned chunks, one per thread. A counting pass sizes every chunk, a
+	 *   prefix sum places it and the chunks parse straight into arcs in file
+	 *   order; verts gets one past the largest id. The header line must come
+	 *   before the first arc, counts are checked as in the serial read.
+	 */
+	template <typename ArcType>
+	void Process_Graph_Parallel(const char* File, std::vector<ArcType>& out, U_INT& verts, size_t threads) {
+		MappedFile M(File);
+		ChunkVecT C;
+		Split(M.data(),M.end(),GRAPH_DATA,threads,C);
+		Parallel(C,boost::bind(&ReadDimacs::CountLines,_1,'a'));
+		size_t total=0;
+		for (size_t i=0; i<C.size(); ++i) {
+			C[i].offset=total;
+			total+=C[i].count;
+		}
+		if (total && total!=arcs) throw local_exception("Arc count Mismatch");
+		out.resize(total);
+		Parallel(C,boost::bind(&ReadDimacs::ParseArcs<ArcType>,_1,total ? &out[0] : 0));
+		verts=0;
+		for (size_t i=0; i<C.size(); ++i)
+			verts=std::max(verts,C[i].verts);
+	}
+	/**
+	 * Process_Coords_Parallel: coordinates parsed as above, each line goes
+	 *   to out[id] so no counting pass is needed, out must hold every id
+	 */
+	template <typename NodeType>
+	void Process_Coords_Parallel(const char* File, std::vector<NodeType>& out, size_t threads) {
+		MappedFile M(File);
+		ChunkVecT C;
+		Split(M.data(),M.end(),COORDS_DATA,threads,C);
+		Parallel(C,boost::bind(&ReadDimacs::ParseCoords<NodeType>,_1,out.empty() ? 0 : &out[0],out.size()));
+		size_t total=0;
+		for (size_t i=0; i<C.size(); ++i)
+			total+=C[i].count;
+		if (total && total!=nodes) throw local_exception("Coord count Mismatch");
 	}
 	size_t GetNodes() const {
 		return nodes;
 	}
+	/**
+	 * SetMmap: parse files in place from a memory map instead of getline
+	 */
+	void SetMmap(bool m) {
+		use_mmap=m;
+	}
 private:
 	typedef std::vector<std::string> StrVecT;
-	size_t nodes, arcs, probpp;
+	size_t nodes, arcs, probpp, mm_sources, mm_targets, updates;
+	bool use_mmap;
+
+	void Read(const char* File, Graph_ExtrT graph_fn, Coords_ExtrT coords_fn, Probpp_ExtrT probpp_fn,
+	          Vertex_ExtrT source_fn=NULL, Vertex_ExtrT target_fn=NULL, Graph_ExtrT update_fn=NULL,
+	          Coordpp_ExtrT coordpp_fn=NULL) {
+		if (use_mmap) ReadMapped(File,graph_fn,coords_fn,probpp_fn,source_fn,target_fn,update_fn,coordpp_fn);
+		else ReadFile(File,graph_fn,coords_fn,probpp_fn,source_fn,target_fn,update_fn,coordpp_fn);
+	}
 
 	inline StrVecT LineConv(std::string inS, const char* Sep=" ") {
 		StrVecT t;
@@ -65,11 +143,12 @@ private:
 #define FNKCOMP_ONE(ONE)         (a[1]==ONE)
 #define FNKCOMP_TWO(ONE,TWO)     (a[1]==ONE) && (a[2]==TWO)
 #define FNKCOMP_THR(ONE,TWO,THR) (a[1]==ONE) && (a[2]==TWO) && (a[3]==THR)
-	void ReadFile(const char* File, Graph_ExtrT graph_fn, Coords_ExtrT coords_fn, Probpp_ExtrT probpp_fn) {
+	void ReadFile(const char* File, Graph_ExtrT graph_fn, Coords_ExtrT coords_fn, Probpp_ExtrT probpp_fn,
+	              Vertex_ExtrT source_fn, Vertex_ExtrT target_fn, Graph_ExtrT update_fn, Coordpp_ExtrT coordpp_fn) {
 		std::ifstream file(File);
 		if (!file.is_open()) throw local_exception("Cannot Open GraphFile");
 		std::string line;
-		size_t count_arcs=0,count_nodes=0,count_probpp=0;
+		size_t count_arcs=0,count_nodes=0,count_probpp=0,count_sources=0,count_targets=0,count_updates=0;
 		try {
 			data_type D = ERROR_DATA;
 			while (std::getline(file,line)) {
@@ -93,6 +172,14 @@ private:
 							D = PROBPP_DATA;
 							probpp = atol(a[4].c_str());
 						}
+						if (FNKCOMP_THR("aux","sp","upd")) {
+							D = UPDATE_DATA;
+							updates = atol(a[4].c_str());
+						}
+					} else if (a.size()==6 && FNKCOMP_THR("aux","sp","m2m")) {
+						D = PROBMM_DATA;
+						mm_sources = atol(a[4].c_str());
+						mm_targets = atol(a[5].c_str());
 					} else
 						throw local_exception("Invalid Line p in GraphFile");
 					continue;
@@ -104,6 +191,13 @@ private:
 					++count_arcs;
 					continue;
 				}
+				if (line[0] == 'a' && D==UPDATE_DATA) {
+					StrVecT a=LineConv(line);
+					if (a.size() != 4) throw local_exception("Invalid Line a in UpdateFile");
+					update_fn( (U_INT)atol(a[1].c_str()), (U_INT)atol(a[2].c_str()), (S_INT)atol(a[3].c_str()) );
+					++count_updates;
+					continue;
+				}
 				if ((line[0] == 'v') && (D==COORDS_DATA)) {
 					StrVecT a=LineConv(line);
 					if (a.size() != 4) throw local_exception("Invalid Line v in CoordsFile");
@@ -118,6 +212,26 @@ private:
 					++count_probpp;
 					continue;
 				}
+				if ((line[0] == 'x') && (D==PROBPP_DATA) && coordpp_fn) {
+					StrVecT a=LineConv(line);
+					if (a.size() != 5) throw local_exception("Invalid Line x in P2P ProblemFile");
+					coordpp_fn( (S_INT)atol(a[1].c_str()), (S_INT)atol(a[2].c_str()),
+					            (S_INT)atol(a[3].c_str()), (S_INT)atol(a[4].c_str()) );
+					++count_probpp;
+					continue;
+				}
+				if ((line[0] == 's' || line[0] == 't') && (D==PROBMM_DATA)) {
+					StrVecT a=LineConv(line);
+					if (a.size() != 2) throw local_exception("Invalid Line s or t in M2M ProblemFile");
+					if (line[0] == 's') {
+						source_fn( (U_INT)atol(a[1].c_str()) );
+						++count_sources;
+					} else {
+						target_fn( (U_INT)atol(a[1].c_str()) );
+						++count_targets;
+					}
+					continue;
+				}
 				throw local_exception("Invalid Line unknown in GraphFile");
 			}
 		} catch (local_exception d) {
@@ -131,6 +245,295 @@ private:
 		if (count_arcs && count_arcs!=arcs) throw local_exception("Arc count Mismatch");
 		if (count_nodes && count_nodes!=nodes) throw local_exception("Coord count Mismatch");
 		if (count_probpp && count_probpp!=probpp) throw local_exception("Problem p2p count Mismatch");
+		if (count_sources!=mm_sources || count_targets!=mm_targets) throw local_exception("Problem m2m count Mismatch");
+		if (count_updates && count_updates!=updates) throw local_exception("Update count Mismatch");
+	}
+
+	/** Token: word inside a mapped line */
+	struct Token {
+		const char* p;
+		size_t len;
+		bool is(const char* w) const {
+			return (strlen(w)==len) && !memcmp(p,w,len);
+		}
+	};
+	static inline bool IsBlank(char c) {
+		return c==' ' || c=='\t' || c=='\r';
+	}
+	/** NextToken: next blank separated word before eol, false at eol */
+	static inline bool NextToken(const char*& q, const char* eol, Token& t) {
+		while (q<eol && IsBlank(*q)) ++q;
+		if (q==eol) return false;
+		t.p=q;
+		while (q<eol && !IsBlank(*q)) ++q;
+		t.len=q-t.p;
+		return true;
+	}
+	/** NextInt: next blank separated signed integer, false if missing or malformed */
+	static inline bool NextInt(const char*& q, const char* eol, long& v) {
+		while (q<eol && IsBlank(*q)) ++q;
+		bool neg = (q<eol && *q=='-');
+		if (neg) ++q;
+		if (q==eol || (unsigned)(*q-'0')>9) return false;
+		long n=0;
+		while (q<eol && (unsigned)(*q-'0')<=9) n = n*10 + (*q++-'0');
+		if (q<eol && !IsBlank(*q)) return false;
+		v = neg ? -n : n;
+		return true;
+	}
+	static inline bool AtEol(const char* q, const char* eol) {
+		while (q<eol && IsBlank(*q)) ++q;
+		return q==eol;
+	}
+	static inline long TokenInt(const Token& t) {
+		const char* q=t.p;
+		long v=0;
+		NextInt(q,t.p+t.len,v);
+		return v;
+	}
+
+	/**
+	 * Header: the p line after its first char, sets the counts it declares
+	 *         and D to the kind of data that follows
+	 */
+	void Header(const char* q, const char* eol, data_type& D) {
+		Token a[6];
+		size_t n=1;
+		while (n<6 && NextToken(q,eol,a[n])) ++n;
+		if (n==4) {
+			if (a[1].is("sp")) {
+				D = GRAPH_DATA;
+				nodes = TokenInt(a[2]);
+				arcs = TokenInt(a[3]);
+			}
+		} else if (n==5) {
+			if (a[1].is("aux") && a[2].is("sp") && a[3].is("co")) {
+				if (nodes != (size_t)TokenInt(a[4]))
+					throw local_exception("Coord != Node  Mismatch");
+				D = COORDS_DATA;
+			}
+			if (a[1].is("aux") && a[2].is("sp") && a[3].is("p2p")) {
+				D = PROBPP_DATA;
+				probpp = TokenInt(a[4]);
+			}
+			if (a[1].is("aux") && a[2].is("sp") && a[3].is("upd")) {
+				D = UPDATE_DATA;
+				updates = TokenInt(a[4]);
+			}
+		} else if (n==6 && a[1].is("aux") && a[2].is("sp") && a[3].is("m2m")) {
+			D = PROBMM_DATA;
+			mm_sources = TokenInt(a[4]);
+			mm_targets = TokenInt(a[5]);
+		} else
+			throw local_exception("Invalid Line p in GraphFile");
+	}
+
+	/**
+	 * ReadMapped: same grammar and checks as ReadFile, numbers are scanned
+	 *             in place from the mapped file without per line allocation
+	 */
+	void ReadMapped(const char* File, Graph_ExtrT graph_fn, Coords_ExtrT coords_fn, Probpp_ExtrT probpp_fn,
+	                Vertex_ExtrT source_fn, Vertex_ExtrT target_fn, Graph_ExtrT update_fn, Coordpp_ExtrT coordpp_fn) {
+		MappedFile M(File);
+		const char* p = M.data();
+		const char* end = M.end();
+		size_t count_arcs=0,count_nodes=0,count_probpp=0,count_sources=0,count_targets=0,count_updates=0;
+		try {
+			data_type D = ERROR_DATA;
+			while (p<end) {
+				const char* eol = static_cast<const char*>(memchr(p,'\n',end-p));
+				if (!eol) eol=end;
+				const char* q = p+1;
+				char c = *p;
+				p = eol+1;
+				if (AtEol(q-1,eol)) continue;
+				if (c == 'c') continue; // comment
+				if (c == 'p') {
+					Header(q,eol,D);
+					continue;
+				}
+				long x=0,y=0,z=0;
+				if (c == 'a' && D==GRAPH_DATA) {
+					if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !AtEol(q,eol))
+						throw local_exception("Invalid Line a in Graph Data");
+					graph_fn( (U_INT)x, (U_INT)y, (S_INT)z );
+					++count_arcs;
+					continue;
+				}
+				if (c == 'a' && D==UPDATE_DATA) {
+					if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !AtEol(q,eol))
+						throw local_exception("Invalid Line a in UpdateFile");
+					update_fn( (U_INT)x, (U_INT)y, (S_INT)z );
+					++count_updates;
+					continue;
+				}
+				if ((c == 'v') && (D==COORDS_DATA)) {
+					if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !AtEol(q,eol))
+						throw local_exception("Invalid Line v in CoordsFile");
+					coords_fn( (U_INT)x, (S_INT)y, (S_INT)z );
+					++count_nodes;
+					continue;
+				}
+				if ((c == 'q') && (D==PROBPP_DATA)) {
+					if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !AtEol(q,eol))
+						throw local_exception("Invalid Line a in P2P ProblemFile");
+					probpp_fn( (U_INT)x, (S_INT)y );
+					++count_probpp;
+					continue;
+				}
+				if ((c == 'x') && (D==PROBPP_DATA) && coordpp_fn) {
+					long w=0;
+					if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !NextInt(q,eol,w) || !AtEol(q,eol))
+						throw local_exception("Invalid Line x in P2P ProblemFile");
+					coordpp_fn( (S_INT)x, (S_INT)y, (S_INT)z, (S_INT)w );
+					++count_probpp;
+					continue;
+				}
+				if ((c == 's' || c == 't') && (D==PROBMM_DATA)) {
+					if (!NextInt(q,eol,x) || !AtEol(q,eol))
+						throw local_exception("Invalid Line s or t in M2M ProblemFile");
+					if (c == 's') {
+						source_fn( (U_INT)x );
+						++count_sources;
+					} else {
+						target_fn( (U_INT)x );
+						++count_targets;
+					}
+					continue;
+				}
+				throw local_exception("Invalid Line unknown in GraphFile");
+			}
+		} catch (const local_exception& d) {
+			throw local_exception(d.what());
+		} catch (...) {
+			throw local_exception("Unknown Exception thrown");
+		}
+		if (count_arcs && count_arcs!=arcs) throw local_exception("Arc count Mismatch");
+		if (count_nodes && count_nodes!=nodes) throw local_exception("Coord count Mismatch");
+		if (count_probpp && count_probpp!=probpp) throw local_exception("Problem p2p count Mismatch");
+		if (count_sources!=mm_sources || count_targets!=mm_targets) throw local_exception("Problem m2m count Mismatch");
+		if (count_updates && count_updates!=updates) throw local_exception("Update count Mismatch");
+	}
+
+	/** Chunk: newline aligned slice of a mapped file and what it held */
+	struct Chunk {
+		Chunk() : begin(0), end(0), count(0), offset(0), verts(0), error(0) {}
+		const char* begin;
+		const char* end;
+		size_t count;
+		size_t offset;
+		U_INT verts;
+		const char* error;
+	};
+	typedef std::vector<Chunk> ChunkVecT;
+	typedef boost::function<void (Chunk&)> Chunk_FnT;
+
+	/**
+	 * Split: read the comments and header line serially, then cut the rest
+	 *        into parts chunks that end just after a newline
+	 */
+	void Split(const char* p, const char* end, data_type want, size_t parts, ChunkVecT& C) {
+		data_type D = ERROR_DATA;
+		while (p<end && D==ERROR_DATA) {
+			const char* eol = static_cast<const char*>(memchr(p,'\n',end-p));
+			if (!eol) eol=end;
+			const char* q = p+1;
+			char c = *p;
+			p = (eol<end) ? eol+1 : end;
+			if (AtEol(q-1,eol) || c == 'c') continue;
+			if (c != 'p') throw local_exception("Invalid Line unknown in GraphFile");
+			Header(q,eol,D);
+		}
+		if (p<end && D!=want) throw local_exception("Invalid Line unknown in GraphFile");
+		parts = std::max(parts,(size_t)1);
+		C.assign(parts,Chunk());
+		for (size_t i=0; i<parts; ++i) {
+			const char* b = (i) ? C[i-1].end : p;
+			const char* e = (i+1==parts) ? end : p + (end-p)*(i+1)/parts;
+			if (e<b) e=b;
+			if (e<end && e>b) {
+				const char* nl = static_cast<const char*>(memchr(e-1,'\n',end-e+1));
+				e = (nl) ? nl+1 : end;
+			}
+			C[i].begin=b;
+			C[i].end=e;
+		}
+	}
+	/**
+	 * Parallel: fn on every chunk, one thread each, rethrows the error of
+	 *           the first chunk that failed so the message is the one a
+	 *           serial read would give
+	 */
+	static void Parallel(ChunkVecT& C, Chunk_FnT fn) {
+		boost::thread_group pool;
+		for (size_t i=1; i<C.size(); ++i)
+			pool.create_thread(boost::bind(fn,boost::ref(C[i])));
+		fn(C[0]);
+		pool.join_all();
+		for (size_t i=0; i<C.size(); ++i)
+			if (C[i].error) throw local_exception(C[i].error);
+	}
+	/** CountLines: lines of the chunk starting with kind */
+	static void CountLines(Chunk& c, char kind) {
+		size_t n=0;
+		for (const char* p=c.begin; p<c.end; ) {
+			if (*p == kind) ++n;
+			const char* eol = static_cast<const char*>(memchr(p,'\n',c.end-p));
+			p = (eol) ? eol+1 : c.end;
+		}
+		c.count=n;
+	}
+	/** ParseArcs: arc lines of the chunk into out from its offset */
+	template <typename ArcType>
+	static void ParseArcs(Chunk& c, ArcType* out) {
+		ArcType* a = out + c.offset;
+		size_t k=0;
+		U_INT verts=0;
+		try {
+			for (const char* p=c.begin; p<c.end; ) {
+				const char* eol = static_cast<const char*>(memchr(p,'\n',c.end-p));
+				if (!eol) eol=c.end;
+				const char* q = p+1;
+				char ch = *p;
+				p = (eol<c.end) ? eol+1 : c.end;
+				if (AtEol(q-1,eol) || ch == 'c') continue;
+				long x=0,y=0,z=0;
+				if (ch != 'a') throw local_exception("Invalid Line unknown in GraphFile");
+				if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !AtEol(q,eol) || k==c.count)
+					throw local_exception("Invalid Line a in Graph Data");
+				a[k++] = ArcType((U_INT)x,(U_INT)y,(S_INT)z);
+				verts = std::max(verts,(U_INT)std::max(x,y)+1);
+			}
+		} catch (local_exception& e) {
+			c.error=e.what();
+		}
+		c.verts=verts;
+	}
+	/** ParseCoords: coordinate lines of the chunk into out by id */
+	template <typename NodeType>
+	static void ParseCoords(Chunk& c, NodeType* out, size_t n) {
+		size_t k=0;
+		try {
+			for (const char* p=c.begin; p<c.end; ) {
+				const char* eol = static_cast<const char*>(memchr(p,'\n',c.end-p));
+				if (!eol) eol=c.end;
+				const char* q = p+1;
+				char ch = *p;
+				p = (eol<c.end) ? eol+1 : c.end;
+				if (AtEol(q-1,eol) || ch == 'c') continue;
+				long x=0,y=0,z=0;
+				if (ch != 'v') throw local_exception("Invalid Line unknown in GraphFile");
+				if (!NextInt(q,eol,x) || !NextInt(q,eol,y) || !NextInt(q,eol,z) || !AtEol(q,eol))
+					throw local_exception("Invalid Line v in CoordsFile");
+				if ((size_t)x>=n) throw local_exception("Cannot insert graph data too large vid");
+				out[x].x = (S_INT)y;
+				out[x].y = (S_INT)z;
+				++k;
+			}
+		} catch (local_exception& e) {
+			c.error=e.what();
+		}
+		c.count=k;
 	}
 };
 } // namespace TestAstar
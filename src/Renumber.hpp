@@ -0,0 +1,229 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_RENUMBER_HPP_
+#define _TESTASTAR_RENUMBER_HPP_
+#include "Locals.hh"
+#include "SearchOptions.hpp"
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+
+namespace TestAstar {
+
+/**
+ * Renumbering: permutation between the ids of the input files (external)
+ *   and the ids of the internal arrays. Built once at load time so that
+ *   vertices close on the map or in the graph get close ids, the graph,
+ *   coordinates and all search state then use internal ids and the graph
+ *   classes translate at their API boundary.
+ */
+class Renumbering {
+public:
+	Renumbering() {}
+	~Renumbering() {}
+
+	/**
+	 * Build: order n vertices by kind, nodes (may be null) give coordinates
+	 *        for the curves, arcs the neighbours for bfs and dfs
+	 */
+	template <typename ArcType, typename NodeType>
+	void Build(renumber_kind kind, size_t n, const std::vector<ArcType>& arcs, const NodeType* nodes) {
+		hExternal.clear();
+		hInternal.clear();
+		if (kind == RENUMBER_NONE || !n) return;
+		if (kind == RENUMBER_BFS || kind == RENUMBER_DFS)
+			Traverse(kind == RENUMBER_BFS, n, arcs);
+		else
+			Curve(kind == RENUMBER_HILBERT, n, nodes);
+		Invert();
+	}
+	/**
+	 * Assign: take a stored order, external id of each internal id
+	 */
+	void Assign(const U_INT* external, size_t n) {
+		hExternal.assign(external, external+n);
+		hInternal.clear();
+		if (n) Invert();
+	}
+	bool Empty() const {
+		return hExternal.empty();
+	}
+	/** Internal: internal id of external id v, identity when empty */
+	inline U_INT Internal(U_INT v) const {
+		return (hExternal.empty() || v >= hInternal.size()) ? v : hInternal[v];
+	}
+	/** External: external id of internal id v, identity when empty */
+	inline U_INT External(U_INT v) const {
+		return (hExternal.empty() || v >= hExternal.size()) ? v : hExternal[v];
+	}
+	/** Order: external id of every internal id, null when empty */
+	const U_INT* Order() const {
+		return hExternal.empty() ? 0 : &hExternal[0];
+	}
+	/**
+	 * Apply: rewrite staged arcs and permute nodes to internal ids
+	 */
+	template <typename ArcType, typename NodeType>
+	void Apply(std::vector<ArcType>& arcs, std::vector<NodeType>& nodes) const {
+		if (hExternal.empty()) return;
+		for (size_t i=0; i<arcs.size(); ++i) {
+			arcs[i].src = hInternal[arcs[i].src];
+			arcs[i].trg = hInternal[arcs[i].trg];
+		}
+		if (nodes.size() != hExternal.size()) return;
+		std::vector<NodeType> moved(nodes.size());
+		for (size_t v=0; v<nodes.size(); ++v)
+			moved[v] = nodes[hExternal[v]];
+		nodes.swap(moved);
+	}
+	/**
+	 * Translate: container of internal ids to external ids in place
+	 */
+	template <typename T>
+	void Translate(T& ids) const {
+		if (hExternal.empty()) return;
+		for (typename T::iterator it=ids.begin(); it!=ids.end(); ++it)
+			*it = hExternal[*it];
+	}
+	/**
+	 * Permute: per vertex values by internal id to values by external id,
+	 *          scratch is swapped in
+	 */
+	template <typename T>
+	void Permute(std::vector<T>& vals, std::vector<T>& scratch) const {
+		if (hExternal.empty()) return;
+		scratch.resize(vals.size());
+		for (size_t v=0; v<vals.size(); ++v)
+			scratch[hExternal[v]] = vals[v];
+		vals.swap(scratch);
+	}
+
+	/**
+	 * HilbertKey: distance along the hilbert curve over the 2^32 square
+	 */
+	static uint64_t HilbertKey(uint32_t x, uint32_t y) {
+		uint64_t d = 0;
+		for (uint32_t s=1U<<31; s; s>>=1) {
+			uint32_t rx = (x & s) ? 1 : 0;
+			uint32_t ry = (y & s) ? 1 : 0;
+			d += (uint64_t)s * s * ((3*rx) ^ ry);
+			if (!ry) {
+				if (rx) {
+					x = ~x;
+					y = ~y;
+				}
+				std::swap(x, y);
+			}
+		}
+		return d;
+	}
+	/**
+	 * MortonKey: bits of x and y interleaved, x in the even bits
+	 */
+	static uint64_t MortonKey(uint32_t x, uint32_t y) {
+		return Spread(x) | (Spread(y) << 1);
+	}
+private:
+	static uint64_t Spread(uint64_t v) {
+		v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+		v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+		v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+		v = (v | (v << 2)) & 0x3333333333333333ULL;
+		v = (v | (v << 1)) & 0x5555555555555555ULL;
+		return v;
+	}
+	/**
+	 * Curve: sort by curve key of the coordinates shifted to unsigned,
+	 *        ties keep file order
+	 */
+	template <typename NodeType>
+	void Curve(bool hilbert, size_t n, const NodeType* nodes) {
+		std::vector<std::pair<uint64_t,U_INT> > keys(n);
+		int64_t minx = 0, miny = 0;
+		if (nodes) {
+			minx = nodes[0].x;
+			miny = nodes[0].y;
+			for (size_t v=1; v<n; ++v) {
+				minx = std::min(minx, (int64_t)nodes[v].x);
+				miny = std::min(miny, (int64_t)nodes[v].y);
+			}
+		}
+		for (size_t v=0; v<n; ++v) {
+			uint32_t x = (nodes) ? (uint32_t)(nodes[v].x - minx) : 0;
+			uint32_t y = (nodes) ? (uint32_t)(nodes[v].y - miny) : 0;
+			keys[v].first = (hilbert) ? HilbertKey(x, y) : MortonKey(x, y);
+			keys[v].second = v;
+		}
+		std::sort(keys.begin(), keys.end());
+		hExternal.resize(n);
+		for (size_t v=0; v<n; ++v)
+			hExternal[v] = keys[v].second;
+	}
+	/**
+	 * Traverse: bfs or preorder dfs over arcs taken both ways, a new tree
+	 *           is started from the lowest unvisited id
+	 */
+	template <typename ArcType>
+	void Traverse(bool bfs, size_t n, const std::vector<ArcType>& arcs) {
+		std::vector<U_INT> first(n+1, 0), adj(2*arcs.size());
+		for (size_t i=0; i<arcs.size(); ++i) {
+			++first[arcs[i].src+1];
+			++first[arcs[i].trg+1];
+		}
+		for (size_t v=0; v<n; ++v)
+			first[v+1] += first[v];
+		std::vector<U_INT> pos(first.begin(), first.end()-1);
+		for (size_t i=0; i<arcs.size(); ++i) {
+			adj[pos[arcs[i].src]++] = arcs[i].trg;
+			adj[pos[arcs[i].trg]++] = arcs[i].src;
+		}
+		std::vector<bool> seen(n, false);
+		std::vector<U_INT> work;
+		hExternal.clear();
+		hExternal.reserve(n);
+		for (size_t root=0; root<n; ++root) {
+			if (seen[root]) continue;
+			if (bfs) {
+				seen[root] = true;
+				size_t head = hExternal.size();
+				hExternal.push_back(root);
+				while (head < hExternal.size()) {
+					U_INT u = hExternal[head++];
+					for (U_INT i=first[u]; i<first[u+1]; ++i) {
+						if (seen[adj[i]]) continue;
+						seen[adj[i]] = true;
+						hExternal.push_back(adj[i]);
+					}
+				}
+			} else {
+				work.push_back(root);
+				while (!work.empty()) {
+					U_INT u = work.back();
+					work.pop_back();
+					if (seen[u]) continue;
+					seen[u] = true;
+					hExternal.push_back(u);
+					for (U_INT i=first[u+1]; i>first[u]; --i)
+						if (!seen[adj[i-1]]) work.push_back(adj[i-1]);
+				}
+			}
+		}
+	}
+	void Invert() {
+		hInternal.resize(hExternal.size());
+		for (size_t v=0; v<hExternal.size(); ++v)
+			hInternal[hExternal[v]] = v;
+	}
+
+	std::vector<U_INT> hExternal;
+	std::vector<U_INT> hInternal;
+};
+} // namespace TestAstar
+#endif
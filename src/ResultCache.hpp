@@ -0,0 +1,238 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_RESULT_CACHE_HPP_
+#define _TESTASTAR_RESULT_CACHE_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <list>
+#include <limits>
+#include <algorithm>
+#include <stdint.h>
+#include <boost/unordered_map.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/graph/graph_traits.hpp>
+
+/** entries of a vertex tried for a subpath hit */
+#define CACHE_PROBES 32
+
+namespace TestAstar {
+
+/**
+ * ResultCache: bounded cache of search results keyed by (src, trg), least
+ *   recently used entries go first once the byte cap is reached.
+ *
+ * Paths marked optimal are also indexed by vertex: every subpath of a
+ * shortest path is a shortest path, so a query whose source and target lie
+ * in that order on a cached optimal path is answered from it, the cost
+ * coming from the prefix costs stored along the path. Results of inexact
+ * searches only answer their own key. One mutex guards everything, a hit
+ * holds it for a hash lookup and a copy.
+ */
+class ResultCache {
+public:
+	/** stats_type: counters since construction */
+	struct stats_type {
+		stats_type() : hits(0), subpath(0), misses(0), evicted(0), entries(0), bytes(0) {}
+		uint64_t hits;
+		uint64_t subpath;
+		uint64_t misses;
+		uint64_t evicted;
+		size_t entries;
+		size_t bytes;
+	};
+
+	ResultCache(size_t bytes) : hCap(bytes), hVersion(0) {}
+	~ResultCache() {}
+
+	/**
+	 * Find: cached path from src to trg, exact key or subpath of an optimal
+	 *       entry, false counts a miss
+	 */
+	template <typename T>
+	bool Find(U_INT src, U_INT trg, T& PathRes, U_INT& Cost) {
+		boost::mutex::scoped_lock lock(hMutex);
+		KeyMapT::iterator it = hKeys.find(Key(src, trg));
+		if (it != hKeys.end()) {
+			const Entry& e = *it->second;
+			Copy(e, 0, e.path.size()-1, PathRes, Cost);
+			Touch(it->second);
+			++hStats.hits;
+			return true;
+		}
+		IndexT::const_iterator ix = hIndex.find(src);
+		if (ix != hIndex.end()) {
+			const std::vector<Occurrence>& occ = ix->second;
+			for (size_t i=0; i<occ.size() && i<CACHE_PROBES; ++i) {
+				EntryIt e = occ[i].first;
+				U_INT from = occ[i].second;
+				std::vector<std::pair<U_INT,U_INT> >::const_iterator p =
+				    std::lower_bound(e->sorted.begin(), e->sorted.end(), std::make_pair(trg, from));
+				if (p == e->sorted.end() || p->first != trg) continue;
+				Copy(*e, from, p->second, PathRes, Cost);
+				Touch(e);
+				++hStats.subpath;
+				return true;
+			}
+		}
+		++hStats.misses;
+		return false;
+	}
+	/**
+	 * Insert: store the path found from src to trg on graph g, optimal says
+	 *         the search was exact so its subpaths may answer other keys,
+	 *         results of weights older than the last Clear are dropped
+	 */
+	template <typename T, typename GraphType>
+	void Insert(U_INT src, U_INT trg, const T& PathRes, U_INT Cost, const GraphType& g, bool optimal,
+	            uint64_t version=0) {
+		if (PathRes.empty()) return;
+		Entry fresh;
+		fresh.src = src;
+		fresh.trg = trg;
+		fresh.cost = Cost;
+		fresh.optimal = optimal;
+		fresh.path.assign(PathRes.begin(), PathRes.end());
+		if (optimal && !Prefix(g, fresh)) fresh.optimal = false;
+		if (fresh.optimal) {
+			fresh.sorted.resize(fresh.path.size());
+			for (size_t i=0; i<fresh.path.size(); ++i)
+				fresh.sorted[i] = std::make_pair(fresh.path[i], (U_INT)i);
+			std::sort(fresh.sorted.begin(), fresh.sorted.end());
+		}
+		fresh.bytes = Bytes(fresh);
+		if (fresh.bytes > hCap) return;
+		boost::mutex::scoped_lock lock(hMutex);
+		if (version != hVersion || hKeys.find(Key(src, trg)) != hKeys.end()) return;
+		hLru.push_front(Entry());
+		EntryIt e = hLru.begin();
+		e->swap(fresh);
+		hKeys[Key(src, trg)] = e;
+		if (e->optimal)
+			for (size_t i=0; i<e->path.size(); ++i)
+				hIndex[e->path[i]].push_back(Occurrence(e, i));
+		hStats.bytes += e->bytes;
+		++hStats.entries;
+		while (hStats.bytes > hCap && !hLru.empty())
+			Evict();
+	}
+	/**
+	 * Clear: drop every entry, the weights changed to version
+	 */
+	void Clear(uint64_t version) {
+		boost::mutex::scoped_lock lock(hMutex);
+		hLru.clear();
+		hKeys.clear();
+		hIndex.clear();
+		hStats.entries = 0;
+		hStats.bytes = 0;
+		hVersion = version;
+	}
+	stats_type Stats() {
+		boost::mutex::scoped_lock lock(hMutex);
+		return hStats;
+	}
+	size_t Capacity() const {
+		return hCap;
+	}
+private:
+	struct Entry {
+		U_INT src;
+		U_INT trg;
+		U_INT cost;
+		bool optimal;
+		size_t bytes;
+		std::vector<U_INT> path;
+		std::vector<U_INT> prefix;
+		std::vector<std::pair<U_INT,U_INT> > sorted;
+		void swap(Entry& o) {
+			std::swap(src, o.src);
+			std::swap(trg, o.trg);
+			std::swap(cost, o.cost);
+			std::swap(optimal, o.optimal);
+			std::swap(bytes, o.bytes);
+			path.swap(o.path);
+			prefix.swap(o.prefix);
+			sorted.swap(o.sorted);
+		}
+	};
+	typedef std::list<Entry>::iterator EntryIt;
+	typedef std::pair<EntryIt,U_INT> Occurrence;
+	typedef boost::unordered_map<uint64_t, EntryIt> KeyMapT;
+	typedef boost::unordered_map<U_INT, std::vector<Occurrence> > IndexT;
+
+	static uint64_t Key(U_INT src, U_INT trg) {
+		return ((uint64_t)src << 32) | trg;
+	}
+	static size_t Bytes(const Entry& e) {
+		return sizeof(Entry) + 64 + e.path.size() * sizeof(U_INT) + e.prefix.size() * sizeof(U_INT)
+		       + e.sorted.size() * (sizeof(std::pair<U_INT,U_INT>) + sizeof(Occurrence));
+	}
+	/**
+	 * Prefix: cost to every path vertex from the cheapest arcs, false if an
+	 *         arc is missing or the total is not the reported cost
+	 */
+	template <typename GraphType>
+	static bool Prefix(const GraphType& g, Entry& e) {
+		e.prefix.assign(e.path.size(), 0);
+		for (size_t i=1; i<e.path.size(); ++i) {
+			U_INT best = std::numeric_limits<U_INT>::max();
+			typename boost::graph_traits<GraphType>::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(e.path[i-1], g); ei != ei_end; ++ei)
+				if (target(*ei, g) == e.path[i] && get(g.weight_map(), *ei) < best)
+					best = get(g.weight_map(), *ei);
+			if (best == std::numeric_limits<U_INT>::max()) return false;
+			e.prefix[i] = e.prefix[i-1] + best;
+		}
+		return e.prefix.back() == e.cost;
+	}
+	template <typename T>
+	static void Copy(const Entry& e, size_t from, size_t to, T& PathRes, U_INT& Cost) {
+		PathRes.clear();
+		for (size_t i=from; i<=to; ++i)
+			PathRes.push_back(e.path[i]);
+		Cost = (from == 0 && to+1 == e.path.size()) ? e.cost : e.prefix[to] - e.prefix[from];
+	}
+	void Touch(EntryIt e) {
+		hLru.splice(hLru.begin(), hLru, e);
+	}
+	/** Evict: drop the least recently used entry and its index slots */
+	void Evict() {
+		EntryIt e = --hLru.end();
+		if (e->optimal) {
+			for (size_t i=0; i<e->path.size(); ++i) {
+				IndexT::iterator ix = hIndex.find(e->path[i]);
+				if (ix == hIndex.end()) continue;
+				std::vector<Occurrence>& occ = ix->second;
+				for (size_t j=0; j<occ.size(); ++j) {
+					if (occ[j].first != e) continue;
+					occ[j] = occ.back();
+					occ.pop_back();
+					break;
+				}
+				if (occ.empty()) hIndex.erase(ix);
+			}
+		}
+		hKeys.erase(Key(e->src, e->trg));
+		hStats.bytes -= e->bytes;
+		--hStats.entries;
+		++hStats.evicted;
+		hLru.erase(e);
+	}
+
+	size_t hCap;
+	uint64_t hVersion;
+	std::list<Entry> hLru;
+	KeyMapT hKeys;
+	IndexT hIndex;
+	stats_type hStats;
+	boost::mutex hMutex;
+};
+} // namespace TestAstar
+#endif
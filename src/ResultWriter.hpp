@@ -0,0 +1,114 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_RESULT_WRITER_HPP_
+#define _TESTASTAR_RESULT_WRITER_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+/**
+ * Binary result layout, native endian:
+ *   magic (8) version (4) endian (4)
+ *   per query: src trg cost count then count vertex ids, all 32 bit,
+ *   a failed query has cost RESULT_NO_PATH and count 0
+ */
+#define RESULT_MAGIC   "TWAYPATH"
+#define RESULT_VERSION 1
+#define RESULT_ENDIAN  0x01020304
+#define RESULT_NO_PATH 0xFFFFFFFFU
+#define RESULT_BUFFER  (1 << 20)
+
+namespace TestAstar {
+
+/** result_format: text lines as printed before, or the binary layout */
+enum result_format { RESULT_TEXT, RESULT_BINARY };
+
+/**
+ * ResultWriter: batch output through one buffer, numbers are formatted in
+ *   place and the buffer goes out with a single fwrite when full or on
+ *   Flush, so a path costs no stream call per vertex
+ */
+class ResultWriter {
+public:
+	ResultWriter(FILE* out, result_format format) : hOut(out), hFormat(format), hUsed(0) {
+		hBuf.resize(RESULT_BUFFER);
+		if (hFormat != RESULT_BINARY) return;
+		uint32_t head[2] = { RESULT_VERSION, RESULT_ENDIAN };
+		Raw(RESULT_MAGIC, 8);
+		Raw(head, sizeof(head));
+	}
+	~ResultWriter() {
+		Flush();
+	}
+	/**
+	 * Write: one query result, path holds count vertex ids
+	 */
+	void Write(U_INT src, U_INT trg, bool found, U_INT cost, const U_INT* path, size_t count) {
+		if (!found) count = 0;
+		if (hFormat == RESULT_BINARY) {
+			uint32_t rec[4] = { src, trg, (found) ? cost : RESULT_NO_PATH, (uint32_t)count };
+			Raw(rec, sizeof(rec));
+			if (count) Raw(path, count * sizeof(U_INT));
+			return;
+		}
+		Text("[");
+		Number(src);
+		Text(" -> ");
+		Number(trg);
+		Text("] ");
+		for (size_t i=0; i<count; ++i) {
+			Text(" - ");
+			Number(path[i]);
+		}
+		Text("\n");
+	}
+	void Flush() {
+		if (hUsed) fwrite(&hBuf[0], 1, hUsed, hOut);
+		hUsed = 0;
+		fflush(hOut);
+	}
+private:
+	void Raw(const void* p, size_t len) {
+		const char* c = (const char*)p;
+		while (len) {
+			if (hUsed == hBuf.size()) {
+				fwrite(&hBuf[0], 1, hUsed, hOut);
+				hUsed = 0;
+			}
+			size_t n = std::min(len, hBuf.size() - hUsed);
+			memcpy(&hBuf[hUsed], c, n);
+			hUsed += n;
+			c += n;
+			len -= n;
+		}
+	}
+	void Text(const char* s) {
+		Raw(s, strlen(s));
+	}
+	void Number(U_INT v) {
+		char tmp[16];
+		char* p = tmp + sizeof(tmp);
+		do {
+			*--p = '0' + v % 10;
+			v /= 10;
+		} while (v);
+		Raw(p, tmp + sizeof(tmp) - p);
+	}
+
+	FILE* hOut;
+	result_format hFormat;
+	std::vector<char> hBuf;
+	size_t hUsed;
+};
+} // namespace TestAstar
+#endif
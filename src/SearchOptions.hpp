@@ -0,0 +1,138 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_SEARCH_OPTIONS_HPP_
+#define _TESTASTAR_SEARCH_OPTIONS_HPP_
+#include "Locals.hh"
+#include <cstring>
+
+namespace TestAstar {
+
+/** queue_kind: priority queue used by the searches */
+enum queue_kind { QUEUE_BINARY, QUEUE_QUATERNARY, QUEUE_RADIX };
+
+/**
+ * ParseQueueKind: binary, 4ary or radix
+ */
+inline queue_kind ParseQueueKind(const char* name)
+{
+	if (!strcmp(name, "binary")) return QUEUE_BINARY;
+	if (!strcmp(name, "4ary")) return QUEUE_QUATERNARY;
+	if (!strcmp(name, "radix")) return QUEUE_RADIX;
+	throw local_exception("Unknown queue kind");
+}
+
+/**
+ * termination_kind: first stops the two way search at the first contact by
+ *   throwing from the visitor, best keeps the cheapest meeting and returns
+ *   once the queue keys prove it, without an exception
+ */
+enum termination_kind { TERMINATE_FIRST, TERMINATE_BEST };
+
+/**
+ * ParseTermination: first or best
+ */
+inline termination_kind ParseTermination(const char* name)
+{
+	if (!strcmp(name, "first")) return TERMINATE_FIRST;
+	if (!strcmp(name, "best")) return TERMINATE_BEST;
+	throw local_exception("Unknown termination");
+}
+
+/**
+ * potential_kind: coordinate heuristic, scaled is the calibrated integer
+ *   bound of Potentials, memo caches it per query, squared is the plain
+ *   squared distance which is fast but not a lower bound
+ */
+enum potential_kind { POTENTIAL_SCALED, POTENTIAL_MEMO, POTENTIAL_SQUARED };
+
+/**
+ * ParsePotential: scaled, memo or squared
+ */
+inline potential_kind ParsePotential(const char* name)
+{
+	if (!strcmp(name, "scaled")) return POTENTIAL_SCALED;
+	if (!strcmp(name, "memo")) return POTENTIAL_MEMO;
+	if (!strcmp(name, "squared")) return POTENTIAL_SQUARED;
+	throw local_exception("Unknown potential");
+}
+
+/**
+ * balance_kind: shared keeps both sides of a two way search in one queue,
+ *   the others split it and pick the side to expand by strict alternation,
+ *   smaller queue or smaller min key
+ */
+enum balance_kind { BALANCE_SHARED, BALANCE_ALTERNATE, BALANCE_SIZE, BALANCE_KEY };
+
+/**
+ * ParseBalance: shared, alternate, size or key
+ */
+inline balance_kind ParseBalance(const char* name)
+{
+	if (!strcmp(name, "shared")) return BALANCE_SHARED;
+	if (!strcmp(name, "alternate")) return BALANCE_ALTERNATE;
+	if (!strcmp(name, "size")) return BALANCE_SIZE;
+	if (!strcmp(name, "key")) return BALANCE_KEY;
+	throw local_exception("Unknown balance policy");
+}
+
+/**
+ * BalanceName: name as accepted by ParseBalance
+ */
+inline const char* BalanceName(balance_kind kind)
+{
+	switch (kind) {
+	case BALANCE_ALTERNATE:
+		return "alternate";
+	case BALANCE_SIZE:
+		return "size";
+	case BALANCE_KEY:
+		return "key";
+	default:
+		return "shared";
+	}
+}
+
+/**
+ * renumber_kind: load time vertex order, none keeps the file ids, hilbert
+ *   and morton sort by a space filling curve over the coordinates, bfs and
+ *   dfs follow the arcs
+ */
+enum renumber_kind { RENUMBER_NONE, RENUMBER_HILBERT, RENUMBER_MORTON, RENUMBER_BFS, RENUMBER_DFS };
+
+/**
+ * ParseRenumber: none, hilbert, morton, bfs or dfs
+ */
+inline renumber_kind ParseRenumber(const char* name)
+{
+	if (!strcmp(name, "none")) return RENUMBER_NONE;
+	if (!strcmp(name, "hilbert")) return RENUMBER_HILBERT;
+	if (!strcmp(name, "morton")) return RENUMBER_MORTON;
+	if (!strcmp(name, "bfs")) return RENUMBER_BFS;
+	if (!strcmp(name, "dfs")) return RENUMBER_DFS;
+	throw local_exception("Unknown renumbering");
+}
+
+/**
+ * partition_kind: arc flag regions, kd splits at the median of the wider
+ *   axis, grid cuts the bounding box into equal cells
+ */
+enum partition_kind { PARTITION_KD, PARTITION_GRID };
+
+/**
+ * ParsePartition: kd or grid
+ */
+inline partition_kind ParsePartition(const char* name)
+{
+	if (!strcmp(name, "kd")) return PARTITION_KD;
+	if (!strcmp(name, "grid")) return PARTITION_GRID;
+	throw local_exception("Unknown partition");
+}
+} // namespace TestAstar
+#endif
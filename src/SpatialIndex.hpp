@@ -0,0 +1,149 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_SPATIAL_INDEX_HPP_
+#define _TESTASTAR_SPATIAL_INDEX_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <stdint.h>
+#include <boost/graph/graph_traits.hpp>
+
+/** points in a kd leaf, scanned in one run */
+#define SPATIAL_LEAF 8
+
+namespace TestAstar {
+
+/**
+ * SpatialIndex: static kd tree over the vertex coordinates for snapping a
+ *   position to the nearest vertices.
+ *
+ * The tree is implicit in one array of points: a range splits at its middle
+ * element on the wider axis, the halves lie on either side, and ranges of
+ * SPATIAL_LEAF points or fewer are leaves. A query walks the near half first
+ * and visits the far half only while the splitting line is closer than the
+ * current k-th best, so it touches a few contiguous leaves. Distances are
+ * squared euclidean in 64 bits.
+ */
+class SpatialIndex {
+public:
+	/** point: position and vertex id, 12 bytes */
+	struct point {
+		S_INT x;
+		S_INT y;
+		U_INT id;
+	};
+	typedef std::pair<uint64_t, U_INT> match_type;
+	typedef std::vector<match_type> MatchVecT;
+
+	SpatialIndex() {}
+	~SpatialIndex() {}
+
+	/**
+	 * Build: index the vertices of g that have an arc, coords may be null
+	 *        which leaves the index empty
+	 */
+	template <typename GraphType, typename NodeType>
+	void Build(const GraphType& g, const NodeType* coords) {
+		hPoints.clear();
+		hAxis.clear();
+		if (!coords) return;
+		for (size_t v=0; v<num_vertices(g); ++v) {
+			if (!out_degree(v, g) && !in_degree(v, g)) continue;
+			point p;
+			p.x = coords[v].x;
+			p.y = coords[v].y;
+			p.id = v;
+			hPoints.push_back(p);
+		}
+		hAxis.assign(hPoints.size(), 0);
+		Split(0, hPoints.size());
+	}
+	size_t Size() const {
+		return hPoints.size();
+	}
+	size_t Bytes() const {
+		return hPoints.size() * (sizeof(point) + sizeof(uint8_t));
+	}
+	/**
+	 * Nearest: up to k nearest vertices to x,y in out, closest first as
+	 *          (squared distance, vertex id), returns how many
+	 */
+	size_t Nearest(S_INT x, S_INT y, size_t k, MatchVecT& out) const {
+		out.clear();
+		if (!k || hPoints.empty()) return 0;
+		Walk(0, hPoints.size(), x, y, k, out);
+		std::sort_heap(out.begin(), out.end());
+		return out.size();
+	}
+private:
+	static inline uint64_t Dist(const point& p, S_INT x, S_INT y) {
+		int64_t dx = (int64_t)p.x - x, dy = (int64_t)p.y - y;
+		return (uint64_t)(dx*dx) + (uint64_t)(dy*dy);
+	}
+	/** AxisLess: orders points on one axis */
+	struct AxisLess {
+		AxisLess(bool ax) : axis(ax) {}
+		bool operator()(const point& a, const point& b) const {
+			return (axis) ? a.y < b.y : a.x < b.x;
+		}
+		bool axis;
+	};
+	void Split(size_t lo, size_t hi) {
+		if (hi - lo <= SPATIAL_LEAF) return;
+		S_INT minx = hPoints[lo].x, maxx = minx, miny = hPoints[lo].y, maxy = miny;
+		for (size_t i=lo; i<hi; ++i) {
+			minx = std::min(minx, hPoints[i].x);
+			maxx = std::max(maxx, hPoints[i].x);
+			miny = std::min(miny, hPoints[i].y);
+			maxy = std::max(maxy, hPoints[i].y);
+		}
+		bool axis = ((int64_t)maxy - miny) > ((int64_t)maxx - minx);
+		size_t mid = lo + (hi - lo) / 2;
+		std::nth_element(hPoints.begin()+lo, hPoints.begin()+mid, hPoints.begin()+hi, AxisLess(axis));
+		hAxis[mid] = axis;
+		Split(lo, mid);
+		Split(mid+1, hi);
+	}
+	/** Offer: keep p if it beats the k-th best, out is a max heap */
+	static inline void Offer(const point& p, S_INT x, S_INT y, size_t k, MatchVecT& out) {
+		uint64_t d = Dist(p, x, y);
+		if (out.size() < k) {
+			out.push_back(match_type(d, p.id));
+			std::push_heap(out.begin(), out.end());
+		} else if (match_type(d, p.id) < out.front()) {
+			std::pop_heap(out.begin(), out.end());
+			out.back() = match_type(d, p.id);
+			std::push_heap(out.begin(), out.end());
+		}
+	}
+	void Walk(size_t lo, size_t hi, S_INT x, S_INT y, size_t k, MatchVecT& out) const {
+		if (hi - lo <= SPATIAL_LEAF) {
+			for (size_t i=lo; i<hi; ++i) Offer(hPoints[i], x, y, k, out);
+			return;
+		}
+		size_t mid = lo + (hi - lo) / 2;
+		const point& m = hPoints[mid];
+		int64_t diff = (hAxis[mid]) ? (int64_t)y - m.y : (int64_t)x - m.x;
+		Offer(m, x, y, k, out);
+		if (diff < 0) Walk(lo, mid, x, y, k, out);
+		else Walk(mid+1, hi, x, y, k, out);
+		if (out.size() < k || (uint64_t)(diff*diff) <= out.front().first) {
+			if (diff < 0) Walk(mid+1, hi, x, y, k, out);
+			else Walk(lo, mid, x, y, k, out);
+		}
+	}
+
+	std::vector<point> hPoints;
+	std::vector<uint8_t> hAxis;
+};
+} // namespace TestAstar
+#endif
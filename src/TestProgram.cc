@@ -11,22 +11,32 @@
 #include <iostream>
 #include <iomanip>
 #include <cstdlib>
+#include <cstring>
 #include <vector>
-#include <list>
 #include <limits>
+#include <algorithm>
 #include <boost/bind.hpp>
+#include <unistd.h>
 #include "Timer.hpp"
 #include "ReadDimacs.hpp"
+#include "BatchExecutor.hpp"
+#include "Benchmark.hpp"
+#include "ResultWriter.hpp"
+#include "DistanceMatrix.hpp"
+#include "OneToAll.hpp"
+#include "QueryServer.hpp"
 
 // #define USE_MANHATTAN_DISTANCE 1
 
 #ifdef COMPILE_WITH_ASTAR
 #include "AstarGraph.hpp"
 #define TESTPROG TestAstar::AstarGraph
+#define TESTNAME "astar"
 #else
 #ifdef COMPILE_WITH_TWAY
 #include "TwayAstarGraph.hpp"
 #define TESTPROG TestAstar::TwayAstarGraph
+#define TESTNAME "tway"
 #endif
 #endif
 
@@ -45,11 +55,11 @@ void use_io(TestAstar::ReadDimacs& R, TESTPROG& S)
 			std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 			std::cout << "Invalid Target " << std::endl;
 		}
-		if ( (src>=R.GetNodes()) || (trg>R.GetNodes()) ) {
-			std::cout << "\n Please use input range " << R.GetNodes() << std::endl;
+		if ( (src>=S.NumVertices()) || (trg>=S.NumVertices()) ) {
+			std::cout << "\n Please use input range " << S.NumVertices() << std::endl;
 			continue;
 		}
-		std::list<U_INT> vlist;
+		std::vector<U_INT> vlist;
 		U_INT t=TestAstar::timer();
 		bool bStat = S.Search(src,trg,vlist,cost);
 		t=TestAstar::timer(t);
@@ -61,74 +71,198 @@ void use_io(TestAstar::ReadDimacs& R, TESTPROG& S)
 // use file
 struct Cont {
 	typedef std::vector<std::pair<U_INT,U_INT> > VecPairT;
-	typedef std::list<U_INT> ListT;
-	typedef std::vector<ListT> VecListT;
+	typedef TestAstar::BatchExecutor<TESTPROG>::PathT PathT;
+	typedef TestAstar::BatchExecutor<TESTPROG>::VecPathT VecPathT;
 	VecPairT inlist;
-	VecListT outlist;
+	VecPathT outlist;
+	std::vector<U_INT> costs;
 	void addin(U_INT s,U_INT t) {
 		inlist.push_back(VecPairT::value_type(s,t));
 	}
-	void addout(std::list<U_INT> v) {
-		outlist.push_back(v);
-	}
 	size_t size() {
 		return inlist.size();
 	}
-	void print() {
+	void print(TestAstar::ResultWriter& W) {
 		if (inlist.size()!=outlist.size()) {
 			std::cerr << " Somewhere this broke " << std::endl;
 			return;
 		}
 		for (std::size_t i=0;i<inlist.size();++i) {
-			std::cout << "[" << inlist[i].first << " -> " << inlist[i].second << "] ";
-			for (ListT::const_iterator jt=outlist[i].begin(); jt!=outlist[i].end(); ++jt) {
-				std::cout << " - " << *jt ;
-			}
-			std::cout << std::endl;
+			const PathT& p=outlist[i];
+			W.Write(inlist[i].first,inlist[i].second,!p.empty(),costs[i],p.empty() ? 0 : &p[0],p.size());
 		}
+		W.Flush();
 	}
 };
 
-void use_file(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file)
+// coordinate queries, both ends snapped to their nearest vertex
+struct ContSnap {
+	ContSnap(Cont& c, TESTPROG& s) : C(c), S(s) {}
+	void add(S_INT x1,S_INT y1,S_INT x2,S_INT y2) {
+		C.addin(S.Snap(x1,y1),S.Snap(x2,y2));
+	}
+	Cont& C;
+	TESTPROG& S;
+};
+void read_queries(TestAstar::ReadDimacs& R, TESTPROG& S, char *problem_file, Cont& C)
+{
+	ContSnap X(C,S);
+	R.Process_P2P_Problem_File(problem_file,boost::bind(boost::mem_fn(&Cont::addin),&C,_1,_2),
+	                           boost::bind(boost::mem_fn(&ContSnap::add),&X,_1,_2,_3,_4));
+}
+
+struct ContUpdate {
+	std::vector<TESTPROG::GraphT::arc_type> batch;
+	void add(U_INT s,U_INT t,S_INT c) {
+		batch.push_back(TESTPROG::GraphT::arc_type(s,t,(U_INT)c));
+	}
+};
+
+void use_file(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file, size_t threads, const char* binary_out)
 {
 	Cont C;
-	std::list<U_INT> blanklist;
-	R.Process_P2P_Problem_File(problem_file,boost::bind(boost::mem_fn(&Cont::addin),&C,_1,_2));
-	size_t county=0,countn=0;
+	read_queries(R,S,problem_file,C);
+	TestAstar::BatchExecutor<TESTPROG> B(S,threads);
 	std::cout << "\nStarting  " << std::endl;
 	U_INT t=TestAstar::timer();
-	for (Cont::VecPairT::const_iterator it=C.inlist.begin(); it!=C.inlist.end(); ++it) {
-		U_INT cost=0;
-		std::list<U_INT> vlist;
-		bool bStat = S.Search(it->first,it->second,vlist,cost);
-		if (bStat) {
-			C.addout(vlist);
-			++county ;
-		} else {
-			C.addout(blanklist);
-			++countn;
-		}
-	}
+	size_t county=B.Run(C.inlist,C.outlist,C.costs);
+	size_t countn=C.size()-county;
 	t=TestAstar::timer(t);
 	std::cout << " Time " << t <<  ", Ave " << (long int)(t/C.size());
 	std::cout << ",Success " << county << ",Fail " << countn << std::endl;
-	C.print();
+	if (!binary_out) {
+		TestAstar::ResultWriter W(stdout,TestAstar::RESULT_TEXT);
+		C.print(W);
+		return;
+	}
+	FILE* f=fopen(binary_out,"wb");
+	if (!f) throw local_exception("Cannot Open result file for write");
+	{
+		TestAstar::ResultWriter W(f,TestAstar::RESULT_BINARY);
+		C.print(W);
+	}
+	fclose(f);
+	std::cout << " Results " << binary_out << std::endl;
+}
+// use file, timing only
+void use_bench(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file, TestAstar::bench_format format,
+               const char* balance)
+{
+	Cont C;
+	read_queries(R,S,problem_file,C);
+	TestAstar::Benchmark<TESTPROG> B(S,TESTNAME,balance);
+	B.Run(C.inlist);
+	B.Report(std::cout,format);
+}
+// use many to many file, costs only
+struct ContM2M {
+	typedef std::vector<U_INT> VecT;
+	VecT sources;
+	VecT targets;
+	void addsource(U_INT s) {
+		sources.push_back(s);
+	}
+	void addtarget(U_INT t) {
+		targets.push_back(t);
+	}
+};
+void use_matrix(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file, size_t threads)
+{
+	ContM2M C;
+	R.Process_M2M_Problem_File(problem_file,boost::bind(boost::mem_fn(&ContM2M::addsource),&C,_1),
+	                           boost::bind(boost::mem_fn(&ContM2M::addtarget),&C,_1));
+	TestAstar::DistanceMatrix<TESTPROG> M(S,threads);
+	ContM2M::VecT out;
+	std::cout << "\nStarting  " << std::endl;
+	U_INT t=TestAstar::timer();
+	size_t reach=M.Run(C.sources,C.targets,out);
+	t=TestAstar::timer(t);
+	std::cout << " Time " << t << ", Rows " << C.sources.size() << ",Cols " << C.targets.size();
+	std::cout << ",Reachable " << reach << std::endl;
+	for (size_t i=0; i<C.sources.size(); ++i) {
+		std::cout << "[" << C.sources[i] << "]";
+		for (size_t j=0; j<C.targets.size(); ++j) {
+			U_INT d = out[i*C.targets.size()+j];
+			if (d == M.Infinity()) std::cout << " -1";
+			else std::cout << " " << d;
+		}
+		std::cout << std::endl;
+	}
+}
+// use file, one to all from every query source
+void use_sweep(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file)
+{
+	Cont C;
+	read_queries(R,S,problem_file,C);
+	TestAstar::OneToAll<TESTPROG> A(S);
+	std::vector<U_INT> dist;
+	std::vector<size_t> reached(C.size());
+	std::vector<U_INT> far(C.size()), cost(C.size());
+	std::cout << "\nStarting  " << std::endl;
+	U_INT t=TestAstar::timer();
+	for (size_t i=0; i<C.size(); ++i) {
+		reached[i]=A.Run(C.inlist[i].first,dist);
+		far[i]=0;
+		for (size_t v=0; v<dist.size(); ++v)
+			if (dist[v]!=A.Infinity() && dist[v]>far[i]) far[i]=dist[v];
+		cost[i]=(C.inlist[i].second<dist.size()) ? dist[C.inlist[i].second] : A.Infinity();
+	}
+	t=TestAstar::timer(t);
+	std::cout << " Time " << t << ", Ave " << (long int)(t/std::max(C.size(),(size_t)1));
+	std::cout << ",Sources " << C.size() << std::endl;
+	for (size_t i=0; i<C.size(); ++i) {
+		std::cout << "[" << C.inlist[i].first << " -> " << C.inlist[i].second << "] Reached " << reached[i];
+		std::cout << " Far " << far[i] << " Cost ";
+		if (cost[i]==A.Infinity()) std::cout << -1;
+		else std::cout << cost[i];
+		std::cout << std::endl;
+	}
+}
+// use file, reachable set within budget from every query source
+void use_isochrone(TestAstar::ReadDimacs& R, TESTPROG& S,char *problem_file, U_INT budget, size_t threads)
+{
+	Cont C;
+	read_queries(R,S,problem_file,C);
+	TestAstar::Isochrone<TESTPROG> I(S,threads);
+	std::vector<U_INT> sources(C.size());
+	for (size_t i=0; i<C.size(); ++i) sources[i]=C.inlist[i].first;
+	std::cout << "\nStarting  " << std::endl;
+	U_INT t=TestAstar::timer();
+	size_t settled=I.Run(sources,budget);
+	t=TestAstar::timer(t);
+	std::cout << " Time " << t << ", Ave " << (long int)(t/std::max(C.size(),(size_t)1));
+	std::cout << ",Sources " << C.size() << ",Budget " << budget << ",Settled " << settled << std::endl;
+	for (size_t i=0; i<C.size(); ++i) {
+		const std::vector<U_INT>& r=I.Reached(i);
+		bool in=std::binary_search(r.begin(),r.end(),C.inlist[i].second);
+		std::cout << "[" << C.inlist[i].first << " -> " << C.inlist[i].second << "] Reached " << r.size();
+		std::cout << " Boundary " << I.Boundary(i).size() << " Target " << ((in) ? "in" : "out") << std::endl;
+	}
+}
+// vertex id, or X,Y snapped to the nearest vertex
+U_INT parse_end(TESTPROG& S, const char* arg)
+{
+	const char* comma=strchr(arg,',');
+	if (!comma) return atol(arg);
+	U_INT v=S.Snap(atol(arg),atol(comma+1));
+	std::cout << " Snap " << arg << " -> " << v << std::endl;
+	return v;
 }
 void use_cmdline(TestAstar::ReadDimacs& R, TESTPROG& S,U_INT src, U_INT trg)
 {
-	if ( (src>=R.GetNodes()) || (trg>R.GetNodes()) ) {
-		std::cout << "\n Please use input range " << R.GetNodes() << std::endl;
+	if ( (src>=S.NumVertices()) || (trg>=S.NumVertices()) ) {
+		std::cout << "\n Please use input range " << S.NumVertices() << std::endl;
 		exit(1);
 	}
 	U_INT cost=0;
-	std::list<U_INT> vlist;
+	std::vector<U_INT> vlist;
 	U_INT t=TestAstar::timer();
 	bool bStat = S.Search(src,trg,vlist,cost);
 	t=TestAstar::timer(t);
 	std::cout << ((bStat)?" Success ":" Fail ") << " Time(ms) " << t;
 	if (bStat) {
 		std::cout << "  Elems " << vlist.size() << " List " << cost << std::endl;
-		for (std::list<U_INT>::const_iterator it=vlist.begin(); it!=vlist.end(); ++it) {
+		for (std::vector<U_INT>::const_iterator it=vlist.begin(); it!=vlist.end(); ++it) {
 			std::cout << " - " << *it ;
 		}
 	}
@@ -137,36 +271,378 @@ void use_cmdline(TestAstar::ReadDimacs& R, TESTPROG& S,U_INT src, U_INT trg)
 
 
 
+// serve queries on a socket
+void use_server(TESTPROG& S, const char* addr, size_t threads)
+{
+	TestAstar::QueryServer<TESTPROG> Q(S,threads);
+	Q.Listen(addr);
+	std::cout << " Serving " << addr << ", Threads " << std::max(threads,(size_t)1) << std::endl;
+	Q.Serve();
+	std::cout << " Server Stopped" << std::endl;
+}
+
+#ifdef COMPILE_WITH_TWAY
+// up to k routes per query, paths printed when asked
+void use_alternatives(TESTPROG& S, const Cont::VecPairT& queries, size_t k, bool paths)
+{
+	TESTPROG::WorkspaceT Work;
+	std::vector<std::vector<U_INT> > routes;
+	std::vector<U_INT> costs;
+	size_t found=0, settled=0;
+	U_INT total=TestAstar::timer();
+	for (size_t q=0; q<queries.size(); ++q) {
+		U_INT t=TestAstar::timer();
+		size_t n=S.Alternatives(queries[q].first,queries[q].second,k,routes,costs,Work);
+		t=TestAstar::timer(t);
+		found+=n;
+		settled+=Work.stats().settled;
+		std::cout << " Query " << queries[q].first << " " << queries[q].second << " Routes " << n;
+		std::cout << " Settled " << Work.stats().settled << " Time(ms) " << t << std::endl;
+		for (size_t i=0; i<n; ++i) {
+			std::cout << "  Route " << i << " Cost " << costs[i] << " Elems " << routes[i].size();
+			if (i) std::cout << " Stretch " << std::fixed << std::setprecision(3) << (double)costs[i]/costs[0];
+			std::cout << std::endl;
+			if (!paths) continue;
+			for (size_t j=0; j<routes[i].size(); ++j)
+				std::cout << " - " << routes[i][j];
+			std::cout << std::endl;
+		}
+	}
+	total=TestAstar::timer(total);
+	std::cout << " Time " << total << ", Queries " << queries.size() << ", Routes " << found;
+	std::cout << ", Settled " << settled << std::endl;
+}
+// print result cache counters
+void print_cache(TESTPROG& S)
+{
+	if (!S.Cache()) return;
+	TestAstar::ResultCache::stats_type st=S.Cache()->Stats();
+	std::cout << " Cache Hits " << st.hits << ", Subpath " << st.subpath << ", Misses " << st.misses;
+	std::cout << ", Evicted " << st.evicted << ", Entries " << st.entries << ", Bytes " << st.bytes << std::endl;
+}
+#endif
+
+void usage(const char* prog)
+{
+	std::cerr << "Usage: " << prog << " [OPTIONS] GRAPHFILE COORDSFILE " << std::endl;
+	std::cerr << "   Or  " << prog << " [OPTIONS] GRAPHFILE COORDSFILE QUERYFILE" << std::endl;
+	std::cerr << "   Or  " << prog << " [OPTIONS] GRAPHFILE COORDSFILE SOURCE TARGET" << std::endl;
+	std::cerr << "        SOURCE and TARGET are vertex ids or X,Y positions snapped to the nearest vertex" << std::endl;
+	std::cerr << "        put -- before them when a position starts with a minus, as in -- -5,3 29,41" << std::endl;
+	std::cerr << "   Or  " << prog << " [OPTIONS] -s SNAPFILE [QUERYFILE | SOURCE TARGET]" << std::endl;
+	std::cerr << "   Or  " << prog << " [OPTIONS] -S ADDR (GRAPHFILE COORDSFILE | -s SNAPFILE)" << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "   -m          : mmap input files and parse in place" << std::endl;
+	std::cerr << "   -s SNAPFILE : load graph from binary snapshot instead of dimacs files" << std::endl;
+	std::cerr << "   -V          : verify snapshot payload checksum on load" << std::endl;
+	std::cerr << "   -w SNAPFILE : write binary snapshot after loading, exit if no query" << std::endl;
+	std::cerr << "   -j THREADS  : worker threads for QUERYFILE or the server, default 1" << std::endl;
+	std::cerr << "   -u          : allow live weight updates, the server then takes u SRC TRG COST lines" << std::endl;
+	std::cerr << "   -U FILE     : apply the weight updates in FILE after loading, implies -u" << std::endl;
+	std::cerr << "   -P THREADS  : parse the dimacs files and build the graph on THREADS threads, 0 all cores" << std::endl;
+	std::cerr << "   -S ADDR     : serve queries on a UNIX socket path, PORT or HOST:PORT until shutdown" << std::endl;
+	std::cerr << "   -O FILE     : write QUERYFILE results to FILE in binary instead of printing paths" << std::endl;
+	std::cerr << "   -b          : benchmark QUERYFILE, per query latency distribution" << std::endl;
+	std::cerr << "   -A          : one to all from every QUERYFILE source, reached count, farthest and target cost" << std::endl;
+	std::cerr << "   -I BUDGET   : vertices within BUDGET cost of every QUERYFILE source and the boundary arcs" << std::endl;
+	std::cerr << "   -M          : QUERYFILE is a many to many file, print the cost matrix, -1 unreachable" << std::endl;
+	std::cerr << "   -o FORMAT   : benchmark report format text, csv or json" << std::endl;
+	std::cerr << "   -r ORDER    : renumber vertices at load, none, hilbert, morton, bfs or dfs, ids shown stay the file ids" << std::endl;
+	std::cerr << "   -q QUEUE    : priority queue binary, 4ary or radix, default binary" << std::endl;
+	std::cerr << "   -T RULE     : termination first (first contact) or best (exact best meeting, lower bound heuristics, not -H squared), default first" << std::endl;
+	std::cerr << "   -H KIND     : coordinate heuristic scaled, memo (scaled, cached per query) or squared, default scaled" << std::endl;
+#ifdef COMPILE_WITH_TWAY
+	std::cerr << "   -c          : build contraction hierarchies, exact shortest paths" << std::endl;
+	std::cerr << "   -l COUNT    : build COUNT ALT landmarks (farthest selection) for the heuristic" << std::endl;
+	std::cerr << "   -L COUNT    : as -l with avoid selection" << std::endl;
+	std::cerr << "   -F REGIONS  : build arc flags for REGIONS coordinate regions on all cores (or -P THREADS)" << std::endl;
+	std::cerr << "   -f SPLIT    : arc flag regions kd (median splits) or grid, default kd" << std::endl;
+	std::cerr << "   -R LIMIT    : build reach bounds below LIMIT cost, prune low reach vertices (threads as -F)" << std::endl;
+	std::cerr << "   -a ROUTES   : shortest path and up to ROUTES-1 alternatives per query, not with -c" << std::endl;
+	std::cerr << "   -K KBYTES   : cache results up to KBYTES, with -c or -T best subpaths of cached paths answer too" << std::endl;
+	std::cerr << "   -d POLICY   : side to expand, shared (one queue), alternate, size or key, default shared" << std::endl;
+#endif
+	exit(1);
+}
+
 int main(int argc, char **argv)
 {
-	if (argc<3 || argc>5) {
-		std::cerr << "Usage: " << argv[0] << " GRAPHFILE COORDSFILE " << std::endl;
-		std::cerr << "   Or  " << argv[0] << " GRAPHFILE COORDSFILE QUERYFILE" << std::endl;
-		std::cerr << "   Or  " << argv[0] << " GRAPHFILE COORDSFILE SOURCE TARGET" << std::endl;
-		exit(1);
+	bool use_mmap=false, verify_snap=false, use_updates=false;
+	size_t threads=1, load_threads=1;
+	bool use_bench_mode=false, use_matrix_mode=false, use_sweep_mode=false;
+	U_INT budget=0;
+	TestAstar::bench_format format=TestAstar::BENCH_TEXT;
+	TestAstar::queue_kind queue=TestAstar::QUEUE_BINARY;
+	TestAstar::termination_kind term=TestAstar::TERMINATE_FIRST;
+	TestAstar::potential_kind potential=TestAstar::POTENTIAL_SCALED;
+	TestAstar::renumber_kind renumber=TestAstar::RENUMBER_NONE;
+#ifdef COMPILE_WITH_TWAY
+	bool use_ch=false;
+	size_t cache_kb=0;
+	size_t landmarks=0;
+	TestAstar::landmark_selection lm_method=TestAstar::LANDMARK_FARTHEST;
+	size_t regions=0;
+	TestAstar::partition_kind partition=TestAstar::PARTITION_KD;
+	U_INT reach_limit=0;
+	size_t alternatives=0;
+	TestAstar::balance_kind balance=TestAstar::BALANCE_SHARED;
+	const char* balance_name=TestAstar::BalanceName(balance);
+#else
+	const char* balance_name="none";
+#endif
+	const char *snap_in=NULL, *snap_out=NULL, *serve_addr=NULL, *binary_out=NULL, *update_file=NULL;
+	int opt;
+	while ((opt=getopt(argc,argv,"a:Abcd:f:F:H:I:j:K:l:L:mMo:O:P:q:r:R:s:S:T:uU:Vw:")) != -1) {
+		switch (opt) {
+#ifdef COMPILE_WITH_TWAY
+		case 'c':
+			use_ch=true;
+			break;
+		case 'K':
+			cache_kb=atol(optarg);
+			break;
+		case 'l':
+		case 'L':
+			landmarks=atol(optarg);
+			lm_method=(opt=='L') ? TestAstar::LANDMARK_AVOID : TestAstar::LANDMARK_FARTHEST;
+			break;
+		case 'F':
+			regions=atol(optarg);
+			break;
+		case 'f':
+			try {
+				partition=TestAstar::ParsePartition(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'R':
+			reach_limit=atol(optarg);
+			break;
+		case 'a':
+			alternatives=atol(optarg);
+			break;
+		case 'd':
+			try {
+				balance=TestAstar::ParseBalance(optarg);
+				balance_name=TestAstar::BalanceName(balance);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+#endif
+		case 'A':
+			use_sweep_mode=true;
+			break;
+		case 'I':
+			budget=atol(optarg);
+			break;
+		case 'b':
+			use_bench_mode=true;
+			break;
+		case 'o':
+			try {
+				format=TestAstar::ParseBenchFormat(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'O':
+			binary_out=optarg;
+			break;
+		case 'P':
+			load_threads=atol(optarg);
+			if (!load_threads) load_threads=std::max(boost::thread::hardware_concurrency(),1U);
+			break;
+		case 'q':
+			try {
+				queue=TestAstar::ParseQueueKind(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'r':
+			try {
+				renumber=TestAstar::ParseRenumber(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'T':
+			try {
+				term=TestAstar::ParseTermination(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'H':
+			try {
+				potential=TestAstar::ParsePotential(optarg);
+			} catch (const local_exception&) {
+				usage(argv[0]);
+			}
+			break;
+		case 'j':
+			threads=atol(optarg);
+			break;
+		case 'm':
+			use_mmap=true;
+			break;
+		case 'M':
+			use_matrix_mode=true;
+			break;
+		case 's':
+			snap_in=optarg;
+			break;
+		case 'S':
+			serve_addr=optarg;
+			break;
+		case 'u':
+			use_updates=true;
+			break;
+		case 'U':
+			update_file=optarg;
+			use_updates=true;
+			break;
+		case 'V':
+			verify_snap=true;
+			break;
+		case 'w':
+			snap_out=optarg;
+			break;
+		default:
+			usage(argv[0]);
+		}
 	}
+	// graph files are only positional when not loading a snapshot
+	int nfiles=(snap_in) ? 0 : 2;
+	int nargs=argc-optind-nfiles;
+	char **args=argv+optind+nfiles;
+	if (nargs<0 || nargs>2) usage(argv[0]);
 	try {
 		U_INT t=TestAstar::timer();
 		TestAstar::ReadDimacs R;
 		TESTPROG S;
-		R.Process_Graph_File(argv[1],boost::bind(boost::mem_fn(&TESTPROG::AddEdge),&S,_1,_2,_3));
-		R.Process_Coords_File(argv[2],boost::bind(boost::mem_fn(&TESTPROG::ModifyNode),&S,_1,_2,_3));
+		S.SetQueue(queue);
+		S.SetTermination(term);
+		S.SetPotential(potential);
+		S.SetRenumber(renumber);
+#ifdef COMPILE_WITH_TWAY
+		S.SetBalance(balance);
+#endif
+		size_t nodes=0;
+		if (snap_in) {
+			S.OpenSnapshot(snap_in,verify_snap);
+			// dimacs ids are 1 based, vertex 0 is unused
+			nodes = S.NumVertices() ? S.NumVertices()-1 : 0;
+		} else if (load_threads>1) {
+			std::vector<TESTPROG::GraphT::arc_type> arcs;
+			U_INT verts=0;
+			R.Process_Graph_Parallel(argv[optind],arcs,verts,load_threads);
+			S.AddEdges(arcs,verts);
+			R.Process_Coords_Parallel(argv[optind+1],S.Nodes(),load_threads);
+			S.Finalize(load_threads);
+			nodes = R.GetNodes();
+		} else {
+			R.SetMmap(use_mmap);
+			R.Process_Graph_File(argv[optind],boost::bind(boost::mem_fn(&TESTPROG::AddEdge),&S,_1,_2,_3));
+			R.Process_Coords_File(argv[optind+1],boost::bind(boost::mem_fn(&TESTPROG::ModifyNode),&S,_1,_2,_3));
+			S.Finalize();
+			nodes = R.GetNodes();
+		}
 		t=TestAstar::timer(t);
-		std::cout << " Load Time(ms) " << t << ", Vertices " << R.GetNodes() << std::endl;
-		switch (argc) {
-		case 3:
+		std::cout << " Load Time(ms) " << t << ", Vertices " << nodes << std::endl;
+		if (snap_out) {
+			t=TestAstar::timer();
+			S.WriteSnapshot(snap_out);
+			t=TestAstar::timer(t);
+			std::cout << " Snapshot Time(ms) " << t << ", File " << snap_out << std::endl;
+			if (!nargs) return 0;
+		}
+#ifdef COMPILE_WITH_TWAY
+		if (use_ch) {
+			t=TestAstar::timer();
+			size_t shortcuts=S.BuildHierarchy();
+			t=TestAstar::timer(t);
+			std::cout << " Hierarchy Time(ms) " << t << ", Shortcuts " << shortcuts << std::endl;
+		}
+		if (landmarks) {
+			t=TestAstar::timer();
+			landmarks=S.BuildLandmarks(landmarks,lm_method);
+			t=TestAstar::timer(t);
+			std::cout << " Landmarks Time(ms) " << t << ", Landmarks " << landmarks << std::endl;
+		}
+		if (regions) {
+			t=TestAstar::timer();
+			regions=S.BuildArcFlags(regions,partition,(load_threads>1) ? load_threads : 0);
+			t=TestAstar::timer(t);
+			std::cout << " Arc flags Time(ms) " << t << ", Regions " << regions << ", Bytes " << S.Flags()->Bytes() << std::endl;
+		}
+		if (reach_limit) {
+			t=TestAstar::timer();
+			size_t bounded=S.BuildReach(reach_limit,(load_threads>1) ? load_threads : 0);
+			t=TestAstar::timer(t);
+			std::cout << " Reach Time(ms) " << t << ", Bounded " << bounded << ", Bytes " << S.Reach()->Bytes() << std::endl;
+		}
+		if (cache_kb) S.EnableCache(cache_kb << 10);
+#endif
+		if (use_updates) S.EnableUpdates();
+		if (update_file) {
+			ContUpdate U;
+			R.Process_Update_File(update_file,boost::bind(boost::mem_fn(&ContUpdate::add),&U,_1,_2,_3));
+			t=TestAstar::timer();
+			size_t changed=S.UpdateWeights(U.batch);
+			t=TestAstar::timer(t);
+			std::cout << " Update Time(ms) " << t << ", Arcs " << changed << ", Version " << S.WeightVersion() << std::endl;
+		}
+		if (serve_addr) {
+			use_server(S,serve_addr,threads);
+#ifdef COMPILE_WITH_TWAY
+			print_cache(S);
+#endif
+			return 0;
+		}
+#ifdef COMPILE_WITH_TWAY
+		if (alternatives && nargs) {
+			Cont C;
+			if (nargs==1) read_queries(R,S,args[0],C);
+			else {
+				U_INT src=parse_end(S,args[0]);
+				C.addin(src,parse_end(S,args[1]));
+			}
+			use_alternatives(S,C.inlist,alternatives,nargs==2);
+			return 0;
+		}
+#endif
+		switch (nargs) {
+		case 0:
 			use_io(R,S);
 			break;
-		case 4:
-			use_file(R,S,argv[3]);
+		case 1:
+			if (use_sweep_mode)
+				use_sweep(R,S,args[0]);
+			else if (budget)
+				use_isochrone(R,S,args[0],budget,threads);
+			else if (use_matrix_mode)
+				use_matrix(R,S,args[0],threads);
+			else if (use_bench_mode)
+				use_bench(R,S,args[0],format,balance_name);
+			else
+				use_file(R,S,args[0],threads,binary_out);
 			break;
-		case 5:
-			use_cmdline(R,S, atol(argv[3]),atol(argv[4]));
+		case 2:
+			{
+				U_INT src=parse_end(S,args[0]);
+				use_cmdline(R,S,src,parse_end(S,args[1]));
+			}
 			break;
 		default:
 			std::cerr << "Illogical !! " << std::endl;
 			break;
 		}
+#ifdef COMPILE_WITH_TWAY
+		print_cache(S);
+#endif
 	} catch (local_exception d) {
 		std::cerr << "Error: " << d.what() << std::endl;
 	} catch (std::exception d) {
@@ -176,6 +652,3 @@ int main(int argc, char **argv)
 	}
 	return 0;
 }
-
-
-
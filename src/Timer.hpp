@@ -12,6 +12,8 @@
 #include <sys/time.h>
 #include <sys/resource.h>
 #include <unistd.h>
+#include <time.h>
+#include <stdint.h>
 
 namespace TestAstar {
 U_INT timer(U_INT Elapsed=0L)
@@ -20,5 +22,14 @@ U_INT timer(U_INT Elapsed=0L)
 	gettimeofday(&x,NULL);
 	return (U_INT)((x.tv_sec*1000L)+(x.tv_usec/1000L)) -Elapsed;
 }
+/**
+ * nanotimer: monotonic clock in nanoseconds, unaffected by wall clock changes
+ */
+inline uint64_t nanotimer(uint64_t Elapsed=0)
+{
+	struct timespec x;
+	clock_gettime(CLOCK_MONOTONIC,&x);
+	return (uint64_t)x.tv_sec*1000000000ULL + x.tv_nsec - Elapsed;
+}
 }
 #endif
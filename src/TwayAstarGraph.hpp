@@ -10,13 +10,32 @@
 #ifndef _TESTASTAR_TWAYASTAR_GRAPH_HPP_
 #define _TESTASTAR_TWAYASTAR_GRAPH_HPP_
 #include "Locals.hh"
+#include "GraphSnapshot.hpp"
+#include "ContractionHierarchy.hpp"
+#include "Landmarks.hpp"
+#include "SearchOptions.hpp"
+#include "Potentials.hpp"
+#include "SpatialIndex.hpp"
+#include "OneToAll.hpp"
+#include "Isochrone.hpp"
+#include "Renumber.hpp"
+#include "ParallelBuild.hpp"
+#include "ResultCache.hpp"
+#include "WeightUpdates.hpp"
+#include "ArcFlags.hpp"
+#include "ReachBounds.hpp"
+#include "Alternatives.hpp"
 #include <boost/tuple/tuple.hpp>
-#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/tway_csr_graph.hpp>
 #include <boost/graph/graph_traits.hpp>
 #include <iostream>
 #include <vector>
+#include <algorithm>
 #include <cstdlib>
+#include <limits>
 #include <boost/graph/tway_astar_search.hpp>
+#include <boost/graph/tway_search_workspace.hpp>
+#include <boost/graph/tway_queue.hpp>
 
 namespace TestAstar {
 /** xNode: struct to hold node */
@@ -25,23 +44,36 @@ struct xNode {
 	S_INT x;
 	S_INT y;
 };
-/** xEdge: struct to hold edge */
-struct xEdge {
-	xEdge() : cost(0) {}
-	U_INT cost;
-};
 /** found_goal:  Exception struct throwable*/
 struct found_goal {};
 /**
- * astar_goal_visitor: Visitor for astar, right now only termination
+ * astar_goal_visitor: Visitor for astar, termination and settled count,
+ *   forward counts the settled vertices of the silver side, told by is_fwd
+ *   when the sides keep apart labels; via if given collects them all
  */
+template<typename ColorMap>
 struct astar_goal_visitor : public boost::default_tway_astar_visitor {
 public:
-	astar_goal_visitor() {}
+	astar_goal_visitor(std::size_t& settled, std::size_t& forward, ColorMap color, AlternativeRoutes* via=0,
+	                   const bool* is_fwd=0)
+		: m_settled(&settled), m_forward(&forward), m_color(color), m_via(via), m_is_fwd(is_fwd) {}
+	template<typename VertexType, typename GraphType>
+	void examine_vertex(VertexType u, GraphType& g) {
+		++*m_settled;
+		if ((m_is_fwd) ? *m_is_fwd : get(m_color, u) == boost::color_traits<boost::tway_color_type>::silver())
+			++*m_forward;
+		if (m_via) m_via->Add(u);
+	}
 	template<typename EdgeType, typename GraphType>
 	void intersect_found(EdgeType e, GraphType& g) {
 		throw found_goal();
 	}
+private:
+	std::size_t* m_settled;
+	std::size_t* m_forward;
+	ColorMap m_color;
+	AlternativeRoutes* m_via;
+	const bool* m_is_fwd;
 };
 
 /**
@@ -51,91 +83,601 @@ template<typename GraphType>
 struct distance_heuristic : public boost::tway_astar_heuristic<GraphType, U_INT> {
 public:
 	typedef typename boost::graph_traits<GraphType>::vertex_descriptor vertex_descriptor;
-	distance_heuristic(GraphType& g, vertex_descriptor goal) : m_g(g), m_goal(goal) {}
+	distance_heuristic(const xNode* nodes, vertex_descriptor goal) : m_nodes(nodes), m_goal(goal) {}
 	U_INT operator()(vertex_descriptor u) {
 #ifdef USE_MANHATTAN_DISTANCE
-		return (labs(m_g[m_goal].x - m_g[u].x) + labs( m_g[m_goal].y - m_g[u].y))/2;
+		return (labs(m_nodes[m_goal].x - m_nodes[u].x) + labs( m_nodes[m_goal].y - m_nodes[u].y))/2;
 #else
-		return pow(m_g[m_goal].x - m_g[u].x,2) + pow(m_g[m_goal].y - m_g[u].y,2);
+		return pow(m_nodes[m_goal].x - m_nodes[u].x,2) + pow(m_nodes[m_goal].y - m_nodes[u].y,2);
 #endif
 	}
 private:
-	GraphType& m_g;
+	const xNode* m_nodes;
 	vertex_descriptor m_goal;
 };
 
 class TwayAstarGraph {
 
 public:
-	typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, xNode, xEdge> GraphT;
-	TwayAstarGraph() {}
+	typedef boost::tway_csr_graph<U_INT, U_INT> GraphT;
+	typedef boost::graph_traits<GraphT>::vertex_descriptor VertexT;
+	typedef PotentialWorkspace<boost::tway_search_workspace<VertexT, U_INT, boost::tway_color_type> > WorkspaceT;
+	typedef boost::tway_indexed_heap<VertexT, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> QueueT;
+	typedef boost::tway_dary_heap<VertexT, 4, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> Queue4T;
+	typedef boost::tway_radix_heap<VertexT, WorkspaceT::cost_map_type, WorkspaceT::index_in_heap_map_type> RadixQueueT;
+	TwayAstarGraph() : hCoords(0), hVerts(0), hQueue(QUEUE_BINARY), hTerm(TERMINATE_FIRST), hBalance(BALANCE_SHARED),
+		hPotential(POTENTIAL_SCALED), hRenumber(RENUMBER_NONE) {}
 	~TwayAstarGraph() {}
 	/**
-	 * AddEdge: Add Graph Edge
+	 * AddEdge: Add Graph Edge, staged until Finalize
 	 */
 	void AddEdge(U_INT src, U_INT trg, S_INT cost) {
-		typedef boost::graph_traits<GraphT>::edge_descriptor edge_descriptor;
-		bool Ins;
-		edge_descriptor Edge;
-		boost::tie(Edge, Ins) = boost::add_edge(src,trg,hGraph);
-		if (!Ins) throw local_exception("Cannot insert graph data");
-		hGraph[Edge].cost=cost;
+		hArcs.push_back(GraphT::arc_type(src,trg,cost));
+		if (src>=hVerts) hVerts=src+1;
+		if (trg>=hVerts) hVerts=trg+1;
+	}
+	/**
+	 * AddEdges: take a whole staged arc array from a bulk loader in place of
+	 *           AddEdge calls, verts is one past the largest id
+	 */
+	void AddEdges(std::vector<GraphT::arc_type>& arcs, U_INT verts) {
+		hArcs.swap(arcs);
+		hVerts = std::max(hVerts, verts);
+	}
+	/**
+	 * Nodes: coordinate array sized to the vertices, for a bulk loader in
+	 *        place of ModifyNode calls
+	 */
+	std::vector<xNode>& Nodes() {
+		hNodes.resize(hVerts);
+		return hNodes;
 	}
 	/**
 	 * Modify Node: Add x,y to node
 	 */
 	void ModifyNode(U_INT vid, S_INT x, S_INT y) {
-		typedef boost::graph_traits<GraphT>::vertex_descriptor vertex_descriptor;
-		if (vid>=num_vertices(hGraph))
+		if (vid>=hVerts)
 			throw local_exception("Cannot insert graph data too large vid");
-		vertex_descriptor v = vertex(vid, hGraph);
-		hGraph[v].x = x;
-		hGraph[v].y = y;
+		if (hNodes.size()<hVerts) hNodes.resize(hVerts);
+		hNodes[vid].x = x;
+		hNodes[vid].y = y;
+	}
+	/**
+	 * Finalize: build the read-only graph from the staged edges, call once
+	 *           after loading and before searching, renumbers if asked,
+	 *           the arrays are sorted on threads when more than one
+	 */
+	void Finalize(size_t threads=1) {
+		hNodes.resize(hVerts);
+		hNumber.Build(hRenumber, hVerts, hArcs, hNodes.empty() ? 0 : &hNodes[0]);
+		hNumber.Apply(hArcs, hNodes);
+		ParallelCsr<GraphT>(threads).Build(hVerts, hArcs, hGraph);
+		std::vector<GraphT::arc_type>().swap(hArcs);
+		hCoords = hNodes.empty() ? 0 : &hNodes[0];
+		hPot.Build(hGraph, hCoords);
+		hSpatial.Build(hGraph, hCoords);
+	}
+	/**
+	 * WriteSnapshot: store the finalized graph and coordinates
+	 */
+	void WriteSnapshot(const char* File) const {
+		GraphSnapshot::Write(File, hGraph, hCoords, hNumber.Order());
+	}
+	/**
+	 * OpenSnapshot: map a snapshot, replaces AddEdge, ModifyNode and Finalize
+	 */
+	void OpenSnapshot(const char* File, bool verify) {
+		hSnap.reset(new GraphSnapshot(File, verify));
+		hSnap->Attach(hGraph);
+		hCoords = hSnap->Section<xNode>(SNAP_COORDS, hSnap->Vertices());
+		hVerts = hSnap->Vertices();
+		if (hSnap->Has(SNAP_ORDER))
+			hNumber.Assign(hSnap->Section<U_INT>(SNAP_ORDER, hVerts), hVerts);
+		std::vector<xNode>().swap(hNodes);
+		hPot.Build(hGraph, hCoords);
+		hSpatial.Build(hGraph, hCoords);
+	}
+	/**
+	 * PotentialScale: calibrated cost per coordinate unit
+	 */
+	double PotentialScale() const {
+		return hPot.Scale();
+	}
+	size_t NumVertices() const {
+		return num_vertices(hGraph);
+	}
+	/**
+	 * BuildHierarchy: contract the graph, later searches use the hierarchy
+	 *                 and return exact shortest paths, returns shortcut count
+	 */
+	size_t BuildHierarchy() {
+		if (hUpdates) throw local_exception("Weight updates need a graph without hierarchy");
+		hCH.reset(new ContractionHierarchy());
+		hCH->Build(hGraph);
+		return hCH->Shortcuts();
+	}
+	/**
+	 * BuildLandmarks: ALT tables for count landmarks, later searches use the
+	 *                 landmark bound instead of the coordinate heuristic
+	 */
+	size_t BuildLandmarks(size_t count, landmark_selection method) {
+		hALT.reset(new Landmarks());
+		hALT->Build(hGraph, count, method);
+		return hALT->Count();
+	}
+	/**
+	 * BuildArcFlags: count regions by kind and their arc flags on threads,
+	 *                later searches skip arcs not flagged for the query
+	 *                regions, returns the regions made
+	 */
+	size_t BuildArcFlags(size_t count, partition_kind kind, size_t threads) {
+		if (hUpdates) throw local_exception("Weight updates need a graph without arc flags");
+		hFlags.reset(new ArcFlags());
+		hFlags->Build(hGraph, hCoords, count, kind, threads);
+		return hFlags->Count();
+	}
+	/**
+	 * Flags: the arc flags, null unless built
+	 */
+	const ArcFlags* Flags() const {
+		return hFlags.get();
+	}
+	/**
+	 * BuildReach: reach bounds below limit on threads, later searches drop
+	 *             vertices whose reach is below both their distance from
+	 *             the query end and the lower bound to the other end
+	 */
+	size_t BuildReach(U_INT limit, size_t threads) {
+		if (hUpdates) throw local_exception("Weight updates need a graph without reach bounds");
+		hReach.reset(new ReachBounds());
+		hReach->Build(hGraph, limit, threads);
+		return hReach->Bounded();
+	}
+	/**
+	 * Reach: the reach bounds, null unless built
+	 */
+	const ReachBounds* Reach() const {
+		return hReach.get();
 	}
 
 	/**
-	 * Search: Astar Search by source,target
+	 * EnableCache: results of later searches are cached up to bytes, paths of
+	 *              the hierarchy or of best meeting on lower bounds are
+	 *              optimal and answer subpath queries
+	 */
+	void EnableCache(size_t bytes) {
+		hCache.reset(new ResultCache(bytes));
+	}
+	/**
+	 * Cache: the result cache, null unless enabled
+	 */
+	ResultCache* Cache() const {
+		return hCache.get();
+	}
+	/**
+	 * EnableUpdates: keep versioned weights so UpdateWeights may run while
+	 *                searches do, not with a hierarchy whose shortcuts hold
+	 *                the load time weights
+	 */
+	void EnableUpdates() {
+		if (hCH) throw local_exception("Weight updates need a graph without hierarchy");
+		if (hFlags) throw local_exception("Weight updates need a graph without arc flags");
+		if (hReach) throw local_exception("Weight updates need a graph without reach bounds");
+		hUpdates.reset(new WeightVersions(hGraph.weights(), num_edges(hGraph)));
+	}
+	/**
+	 * CheckUpdate: null if cost may replace the weight of the arcs from src
+	 *              to trg (file ids), else the reason it may not
+	 */
+	const char* CheckUpdate(U_INT src, U_INT trg, S_INT cost) const {
+		if (!hUpdates) return "Weight updates not enabled";
+		if (src>=num_vertices(hGraph) || trg>=num_vertices(hGraph)) return "Update vertex out of range";
+		if (cost<0) return "Update cost negative";
+		U_INT u = hNumber.Internal(src), v = hNumber.Internal(trg);
+		bool found = false;
+		GraphT::out_edge_iterator ei, ei_end;
+		for (boost::tie(ei, ei_end) = out_edges(u, hGraph); ei != ei_end; ++ei) {
+			if (target(*ei, hGraph) != v) continue;
+			found = true;
+			if (hALT && hALT->Count() && (U_INT)cost < hGraph.weight(ei->idx))
+				return "Update below landmark bound";
+		}
+		if (!found) return "Update arc not in graph";
+		if (!(hALT && hALT->Count()) && hPotential != POTENTIAL_SQUARED && !hPot.Admits(u, v, (U_INT)cost))
+			return "Update below coordinate bound";
+		return 0;
+	}
+	/**
+	 * UpdateWeights: new weight for every arc from src to trg of each entry,
+	 *                all are checked before any applies, searches running
+	 *                keep the version they started on; returns arcs changed
+	 */
+	size_t UpdateWeights(const std::vector<GraphT::arc_type>& batch) {
+		WeightVersions::BatchT changes;
+		for (size_t i=0; i<batch.size(); ++i) {
+			const char* why = CheckUpdate(batch[i].src, batch[i].trg, (S_INT)batch[i].weight);
+			if (why) throw local_exception(why);
+			U_INT u = hNumber.Internal(batch[i].src), v = hNumber.Internal(batch[i].trg);
+			GraphT::out_edge_iterator ei, ei_end;
+			for (boost::tie(ei, ei_end) = out_edges(u, hGraph); ei != ei_end; ++ei)
+				if (target(*ei, hGraph) == v)
+					changes.push_back(WeightVersions::change_type(ei->idx, batch[i].weight));
+		}
+		uint64_t version = hUpdates->Apply(changes);
+		if (hCache) hCache->Clear(version);
+		return changes.size();
+	}
+	/**
+	 * WeightVersion: updates applied so far
+	 */
+	uint64_t WeightVersion() const {
+		return (hUpdates) ? hUpdates->Version() : 0;
+	}
+	/**
+	 * SetRenumber: vertex order applied by Finalize, call before it, ids
+	 *              passed in and out stay the file ids
+	 */
+	void SetRenumber(renumber_kind kind) {
+		hRenumber = kind;
+	}
+	/**
+	 * SetQueue: priority queue for later searches
+	 */
+	void SetQueue(queue_kind kind) {
+		hQueue = kind;
+	}
+	/**
+	 * SetTermination: stopping rule for later searches, best is exact for
+	 *                 consistent lower bounds, as the default scaled
+	 *                 potential, memo and landmarks are, not the squared
+	 *                 heuristic
+	 */
+	void SetTermination(termination_kind kind) {
+		hTerm = kind;
+	}
+	/**
+	 * SetBalance: one shared queue or split queues with a side policy
+	 */
+	void SetBalance(balance_kind kind) {
+		hBalance = kind;
+	}
+	/**
+	 * SetPotential: coordinate heuristic for later searches
+	 */
+	void SetPotential(potential_kind kind) {
+		hPotential = kind;
+	}
+
+	/**
+	 * Snap: file id of the vertex with an arc nearest to x,y
+	 */
+	U_INT Snap(S_INT x, S_INT y) const {
+		SpatialIndex::MatchVecT m;
+		if (!hSpatial.Nearest(x, y, 1, m)) throw local_exception("No coordinates to snap to");
+		return hNumber.External(m[0].second);
+	}
+	/**
+	 * Nearest: file ids of up to k vertices nearest to x,y, closest first
+	 */
+	size_t Nearest(S_INT x, S_INT y, size_t k, std::vector<U_INT>& out) const {
+		SpatialIndex::MatchVecT m;
+		out.resize(hSpatial.Nearest(x, y, k, m));
+		for (size_t i=0; i<m.size(); ++i)
+			out[i] = hNumber.External(m[i].second);
+		return out.size();
+	}
+	/**
+	 * Search: Astar Search by source,target using the internal workspace
 	 */
 	template <typename T>
 	bool Search(U_INT src, U_INT trg, T& PathRes, U_INT& Cost) {
-		typedef boost::graph_traits<GraphT>::vertex_descriptor vertex_descriptor;
-		typedef boost::graph_traits<GraphT>::edge_descriptor edge_descriptor;
-		std::vector<vertex_descriptor> predecessors(num_vertices(hGraph));
+		return Search(src,trg,PathRes,Cost,hWork);
+	}
+	/**
+	 * Search: Astar Search by source,target, state kept in caller's workspace
+	 */
+	template <typename T>
+	bool Search(U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
 		if (src>=num_vertices(hGraph) || trg>=num_vertices(hGraph)) return false;
-		vertex_descriptor source_vertex = vertex(src, hGraph);
-		vertex_descriptor target_vertex = vertex(trg, hGraph);
-		std::vector<U_INT> distances(num_vertices(hGraph));
-		typedef std::vector<boost::tway_color_type> colormap_t;
-		colormap_t colors(num_vertices(hGraph));
+		U_INT s = hNumber.Internal(src), t = hNumber.Internal(trg);
+		if (hCache && hCache->Find(s, t, PathRes, Cost)) {
+			Work.stats() = WorkspaceT::stats_type();
+			hNumber.Translate(PathRes);
+			return true;
+		}
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		const GraphT& g = Weighted(pin, view);
+		if (!SearchInternal(g, s, t, PathRes, Cost, Work)) return false;
+		if (hCache) hCache->Insert(s, t, PathRes, Cost, g,
+		                            hCH || (hTerm == TERMINATE_BEST && hPotential != POTENTIAL_SQUARED),
+		                            pin.Version());
+		hNumber.Translate(PathRes);
+		return true;
+	}
+	/**
+	 * Search: as above from and to the vertices snapped to two positions
+	 */
+	template <typename T>
+	bool Search(const xNode& from, const xNode& to, T& PathRes, U_INT& Cost, WorkspaceT& Work) {
+		return Search(Snap(from.x, from.y), Snap(to.x, to.y), PathRes, Cost, Work);
+	}
+	/**
+	 * Alternatives: the shortest path and up to k-1 alternatives of one
+	 *               search, in file ids, returns how many; not with the
+	 *               hierarchy, arc flags and reach are not used
+	 */
+	size_t Alternatives(U_INT src, U_INT trg, size_t k, std::vector<std::vector<U_INT> >& Paths,
+	                    std::vector<U_INT>& Costs, WorkspaceT& Work,
+	                    const AlternativeLimits& limits=AlternativeLimits()) {
+		Paths.clear();
+		Costs.clear();
+		if (src>=num_vertices(hGraph) || trg>=num_vertices(hGraph) || !k) return 0;
+		if (hCH) throw local_exception("Alternatives not with contraction hierarchies");
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		const GraphT& g = Weighted(pin, view);
+		AlternativeRoutes via(limits);
+		std::vector<U_INT> best;
+		U_INT cost;
+		if (!SearchInternal(g, hNumber.Internal(src), hNumber.Internal(trg), best, cost, Work, &via)) return 0;
+		via.Select(g, hPot, best, cost, k, Paths, Costs, Work);
+		for (size_t i=0; i<Paths.size(); ++i)
+			hNumber.Translate(Paths[i]);
+		return Paths.size();
+	}
+	/**
+	 * MatrixTargets: prepare the columns of a distance matrix, buckets from
+	 *                the hierarchy when built, else one per target
+	 */
+	void MatrixTargets(const std::vector<U_INT>& targets, MatrixBuckets& B, WorkspaceT& Work) {
+		std::vector<U_INT> internal(targets);
+		for (size_t j=0; j<internal.size(); ++j)
+			internal[j] = hNumber.Internal(internal[j]);
+		if (hCH) hCH->MatrixTargets(internal, B, Work);
+		else MatrixSweepTargets(hGraph, internal, B);
+	}
+	/**
+	 * MatrixRow: costs from src to all prepared targets, one hierarchy
+	 *            upward search or one dijkstra sweep
+	 */
+	void MatrixRow(U_INT src, const MatrixBuckets& B, U_INT* row, WorkspaceT& Work) {
+		if (hCH) {
+			hCH->MatrixRow(hNumber.Internal(src), B, row, Work);
+			return;
+		}
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		MatrixSweepRow(Weighted(pin, view), hNumber.Internal(src), B, row, Work);
+	}
+	/**
+	 * OneToAll: costs from src to every vertex, a PHAST sweep over the
+	 *           hierarchy when built, else a dijkstra, level is scratch
+	 */
+	void OneToAll(U_INT src, std::vector<U_INT>& dist, std::vector<U_INT>& level, WorkspaceT& Work) {
+		if (hCH) {
+			hCH->OneToAll(hNumber.Internal(src), dist, level, Work);
+		} else {
+			WeightPin pin(hUpdates.get());
+			GraphT view;
+			DijkstraOneToAll(Weighted(pin, view), hNumber.Internal(src), dist, Work);
+		}
+		hNumber.Permute(dist, level);
+	}
+	/**
+	 * Reachable: file ids within budget of src in ascending order and the
+	 *            arcs leaving them past the budget, by a budgeted dijkstra on
+	 *            the original arcs, also with the hierarchy
+	 */
+	void Reachable(U_INT src, U_INT budget, std::vector<U_INT>& reached, std::vector<isochrone_arc>& boundary,
+	               WorkspaceT& Work) {
+		WeightPin pin(hUpdates.get());
+		GraphT view;
+		DijkstraBudget(Weighted(pin, view), hNumber.Internal(src), budget, reached, boundary, Work);
+		hNumber.Translate(reached);
+		std::sort(reached.begin(), reached.end());
+		for (size_t i=0; i<boundary.size(); ++i) {
+			boundary[i].src = hNumber.External(boundary[i].src);
+			boundary[i].trg = hNumber.External(boundary[i].trg);
+		}
+	}
+private:
+	/**
+	 * Weighted: the graph a search reads, a view on the pinned weights when
+	 *           updates are enabled
+	 */
+	const GraphT& Weighted(const WeightPin& pin, GraphT& view) const {
+		if (!pin.Active()) return hGraph;
+		view.view(hGraph, pin.Weights());
+		return view;
+	}
+	/**
+	 * SearchInternal: search on internal ids, via collects alternatives
+	 */
+	template <typename T>
+	bool SearchInternal(const GraphT& g, U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work,
+	                    AlternativeRoutes* via=0) {
+		if (hCH) return hCH->Search(src, trg, PathRes, Cost, Work, hQueue);
+		switch (hQueue) {
+		case QUEUE_QUATERNARY:
+			return SearchHeuristic<Queue4T>(g, src, trg, PathRes, Cost, Work, via);
+		case QUEUE_RADIX:
+			return SearchHeuristic<RadixQueueT>(g, src, trg, PathRes, Cost, Work, via);
+		default:
+			return SearchHeuristic<QueueT>(g, src, trg, PathRes, Cost, Work, via);
+		}
+	}
+	/**
+	 * SearchHeuristic: picks landmark or coordinate heuristics, best meeting
+	 *                  on landmarks uses the averaged pair
+	 */
+	template <typename QueueType, typename T>
+	bool SearchHeuristic(const GraphT& g, U_INT src, U_INT trg, T& PathRes, U_INT& Cost, WorkspaceT& Work,
+	                     AlternativeRoutes* via) {
+		VertexT source_vertex = vertex(src, g);
+		VertexT target_vertex = vertex(trg, g);
+		if (hALT && hALT->Count() && (hTerm == TERMINATE_BEST || via))
+			return SearchWith<QueueType>(g, source_vertex, target_vertex, PathRes, Cost, Work,
+			                  average_landmark_heuristic<GraphT>(hALT.get(), source_vertex, target_vertex, true),
+			                  average_landmark_heuristic<GraphT>(hALT.get(), source_vertex, target_vertex, false), via);
+		if (hALT && hALT->Count())
+			return SearchWith<QueueType>(g, source_vertex, target_vertex, PathRes, Cost, Work,
+			                  landmark_heuristic<GraphT>(hALT.get(), target_vertex, true),
+			                  landmark_heuristic<GraphT>(hALT.get(), source_vertex, false), via);
+		if (hPotential == POTENTIAL_SQUARED)
+			return SearchWith<QueueType>(g, source_vertex, target_vertex, PathRes, Cost, Work,
+			                  distance_heuristic<GraphT>(hCoords, target_vertex),
+			                  distance_heuristic<GraphT>(hCoords, source_vertex), via);
+		PotentialMemo* memo = 0;
+		if (hPotential == POTENTIAL_MEMO) {
+			memo = &Work.memo();
+			memo->Reset(num_vertices(g));
+		}
+		return SearchWith<QueueType>(g, source_vertex, target_vertex, PathRes, Cost, Work,
+		                  potential_heuristic<GraphT>(&hPot, target_vertex, memo, 0),
+		                  potential_heuristic<GraphT>(&hPot, source_vertex, memo, 1), via);
+	}
+	/**
+	 * SearchWith: tway astar with heuristics h_f towards target, h_r towards source
+	 */
+	template <typename QueueType, typename T, typename HeuristicT>
+	bool SearchWith(const GraphT& g, VertexT source_vertex, VertexT target_vertex, T& PathRes, U_INT& Cost, WorkspaceT& Work,
+	                HeuristicT h_f, HeuristicT h_r, AlternativeRoutes* via) {
+		Work.reset(num_vertices(g), std::numeric_limits<U_INT>::max());
+		if (hTerm == TERMINATE_BEST || via)
+			return SearchBest<QueueType>(g, source_vertex, target_vertex, PathRes, Cost, Work, h_f, h_r, via);
+		WorkspaceT::distance_map_type distances = Work.distance_map();
+		WorkspaceT::cost_map_type costs = Work.cost_map();
+		WorkspaceT::color_map_type colors = Work.color_map();
+		put(distances, source_vertex, 0);
+		put(costs, source_vertex, h_f(source_vertex));
+		put(colors, source_vertex, boost::color_traits<boost::tway_color_type>::silver());
+		put(distances, target_vertex, 0);
+		put(costs, target_vertex, h_r(target_vertex));
+		put(colors, target_vertex, boost::color_traits<boost::tway_color_type>::gold());
+		QueueType Q(QueueType::storage(Work), costs, Work.index_in_heap_map());
+		if (hBalance == BALANCE_SHARED)
+			return SearchOn(g, source_vertex, target_vertex, PathRes, Cost, Work, h_f, h_r, Q);
+		boost::tway_balance_policy policy = (hBalance == BALANCE_ALTERNATE) ? boost::TWAY_BALANCE_ALTERNATE
+		                                    : (hBalance == BALANCE_SIZE) ? boost::TWAY_BALANCE_SIZE : boost::TWAY_BALANCE_KEY;
+		boost::tway_balanced_queue<QueueType, WorkspaceT::cost_map_type, WorkspaceT::color_map_type>
+		BQ(Q, QueueType(QueueType::storage(Work, 1), costs, Work.index_in_heap_map()), costs, colors, policy);
+		return SearchOn(g, source_vertex, target_vertex, PathRes, Cost, Work, h_f, h_r, BQ);
+	}
+	/**
+	 * SearchOn: runs the search on the initialized workspace with queue Q,
+	 *           splicing the two trees at their first contact
+	 */
+	template <typename BufferType, typename T, typename HeuristicT>
+	bool SearchOn(const GraphT& g, VertexT source_vertex, VertexT target_vertex, T& PathRes, U_INT& Cost, WorkspaceT& Work,
+	              HeuristicT h_f, HeuristicT h_r, BufferType& Q) {
+		WorkspaceT::predecessor_map_type predecessors = Work.predecessor_map();
+		WorkspaceT::distance_map_type distances = Work.distance_map();
+		WorkspaceT::cost_map_type costs = Work.cost_map();
+		WorkspaceT::color_map_type colors = Work.color_map();
+		astar_goal_visitor<WorkspaceT::color_map_type> vis(Work.stats().settled, Work.stats().forward, colors);
+		arc_flags_filter flags;
+		if (hFlags && hFlags->Count())
+			flags = arc_flags_filter(hFlags->Forward(hFlags->Region(target_vertex)),
+			                         hFlags->Backward(hFlags->Region(source_vertex)));
+		reach_filter<arc_flags_filter, WorkspaceT::distance_map_type, GraphT::weight_map_type, reach_lower_bound>
+		keep(flags, hReach.get(), distances, distances, g.weight_map(), reach_lower_bound(&hPot, hALT.get()),
+		     source_vertex, target_vertex);
 		try {
-			boost::tway_astar_search(
-			    hGraph, source_vertex, target_vertex,
-			    distance_heuristic<GraphT>(hGraph, target_vertex),
-			    distance_heuristic<GraphT>(hGraph, source_vertex),
-			    boost::predecessor_map(&predecessors[0]).
-			    weight_map(get(( &xEdge::cost ), hGraph)).
-			    distance_map(&distances[0]).
-			    color_map(&colors[0]).
-			    visitor(astar_goal_visitor()) );
+			boost::tway_astar_search_no_init_with_queue(
+			    g, source_vertex, target_vertex, h_f, h_r,
+			    vis, Q, predecessors, costs, distances,
+			    g.weight_map(), colors,
+			    std::less<U_INT>(), boost::closed_plus<U_INT>(),
+			    std::numeric_limits<U_INT>::max(), 0U, keep);
 		} catch (found_goal fg) {
-			Cost=distances[target_vertex];
+			Cost=get(distances, target_vertex);
 			PathRes.clear();
-			PathRes.push_front(target_vertex);
-			size_t max=num_vertices(hGraph);
+			PathRes.push_back(target_vertex);
+			size_t max=num_vertices(g);
 			while (target_vertex != source_vertex) {
-				if (target_vertex == predecessors[target_vertex])
+				if (target_vertex == get(predecessors, target_vertex))
 					return false;
-				target_vertex = predecessors[target_vertex];
-				PathRes.push_front(target_vertex);
+				target_vertex = get(predecessors, target_vertex);
+				PathRes.push_back(target_vertex);
 				if (!max--)
 					return false;
 			}
+			std::reverse(PathRes.begin(), PathRes.end());
 			return true;
 		}
 		return false;
 	}
-private:
+	/**
+	 * SearchBest: best meeting search on the reset workspace, each side on
+	 *             its own queue and labels, side 1 backward; with via
+	 *             stretched past the optimum over the unfiltered graph
+	 */
+	template <typename QueueType, typename T, typename HeuristicT>
+	bool SearchBest(const GraphT& g, VertexT source_vertex, VertexT target_vertex, T& PathRes, U_INT& Cost,
+	                WorkspaceT& Work, HeuristicT h_f, HeuristicT h_r, AlternativeRoutes* via) {
+		typedef boost::tway_search_side<QueueType, WorkspaceT::predecessor_map_type, WorkspaceT::cost_map_type,
+		        WorkspaceT::distance_map_type, WorkspaceT::color_map_type> SideT;
+		QueueType Qf(QueueType::storage(Work), Work.cost_map(), Work.index_in_heap_map());
+		QueueType Qr(QueueType::storage(Work, 1), Work.cost_map(1), Work.index_in_heap_map(1));
+		SideT fwd(Qf, Work.predecessor_map(), Work.cost_map(), Work.distance_map(), Work.color_map());
+		SideT rev(Qr, Work.predecessor_map(1), Work.cost_map(1), Work.distance_map(1), Work.color_map(1));
+		bool is_fwd = true;
+		astar_goal_visitor<WorkspaceT::color_map_type> vis(Work.stats().settled, Work.stats().forward,
+		                                                   fwd.color, via, &is_fwd);
+		arc_flags_filter flags;
+		if (hFlags && hFlags->Count() && !via)
+			flags = arc_flags_filter(hFlags->Forward(hFlags->Region(target_vertex)),
+			                         hFlags->Backward(hFlags->Region(source_vertex)));
+		reach_filter<arc_flags_filter, WorkspaceT::distance_map_type, GraphT::weight_map_type, reach_lower_bound>
+		keep(flags, (via) ? 0 : hReach.get(), fwd.distance, rev.distance, g.weight_map(),
+		     reach_lower_bound(&hPot, hALT.get()), source_vertex, target_vertex);
+		boost::tway_balance_policy policy = (hBalance == BALANCE_ALTERNATE) ? boost::TWAY_BALANCE_ALTERNATE
+		                                    : (hBalance == BALANCE_SIZE) ? boost::TWAY_BALANCE_SIZE : boost::TWAY_BALANCE_KEY;
+		boost::tway_meeting<VertexT, U_INT> meet(std::numeric_limits<U_INT>::max(), (via) ? via->Stretch() : 0);
+		if (!boost::tway_astar_search_best_meeting(
+		            g, source_vertex, target_vertex, h_f, h_r, vis, fwd, rev,
+		            g.weight_map(), std::less<U_INT>(), boost::closed_plus<U_INT>(), 0U,
+		            policy, meet, is_fwd, keep))
+			return false;
+		Cost=meet.cost;
+		PathRes.clear();
+		size_t max=num_vertices(g);
+		for (VertexT v=meet.source; ; v=get(fwd.predecessor, v)) {
+			PathRes.push_back(v);
+			if (v == source_vertex) break;
+			if (v == get(fwd.predecessor, v) || !max--) return false;
+		}
+		std::reverse(PathRes.begin(), PathRes.end());
+		if (meet.source == meet.target) return true;
+		for (VertexT v=meet.target; ; v=get(rev.predecessor, v)) {
+			PathRes.push_back(v);
+			if (v == target_vertex) break;
+			if (v == get(rev.predecessor, v) || !max--) return false;
+		}
+		return true;
+	}
 	GraphT hGraph;
+	std::vector<xNode> hNodes;
+	const xNode* hCoords;
+	std::vector<GraphT::arc_type> hArcs;
+	boost::shared_ptr<GraphSnapshot> hSnap;
+	boost::shared_ptr<ContractionHierarchy> hCH;
+	boost::shared_ptr<Landmarks> hALT;
+	boost::shared_ptr<ResultCache> hCache;
+	boost::shared_ptr<WeightVersions> hUpdates;
+	boost::shared_ptr<ArcFlags> hFlags;
+	boost::shared_ptr<ReachBounds> hReach;
+	Potentials hPot;
+	SpatialIndex hSpatial;
+	U_INT hVerts;
+	queue_kind hQueue;
+	termination_kind hTerm;
+	balance_kind hBalance;
+	potential_kind hPotential;
+	renumber_kind hRenumber;
+	Renumbering hNumber;
+	WorkspaceT hWork;
 };
 } // namespace TestAstar
 #endif
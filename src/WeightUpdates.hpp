@@ -0,0 +1,130 @@
+//=======================================================================
+// Copyright 2010.
+// Authors: S Roychowdhury
+// Project: tway
+//
+// Distributed under the Boost Software License, Version 1.0. (See
+// accompanying file LICENSE_1_0.txt or copy at
+// http://www.boost.org/LICENSE_1_0.txt)
+//=======================================================================
+#ifndef _TESTASTAR_WEIGHT_UPDATES_HPP_
+#define _TESTASTAR_WEIGHT_UPDATES_HPP_
+#include "Locals.hh"
+#include <vector>
+#include <utility>
+#include <stdint.h>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition.hpp>
+
+namespace TestAstar {
+
+/**
+ * WeightVersions: two copies of the edge weights so they can change while
+ *   searches run.
+ *
+ * Readers pin the current copy for the length of one search and see every
+ * weight of one version. A writer brings the idle copy up to date by
+ * replaying the batch it last applied to the other copy plus the new one,
+ * then makes it current; it only waits for searches still pinned to the
+ * idle copy from before the previous switch. The cost of an update is the
+ * size of the two batches, the weight arrays are copied once at start.
+ */
+class WeightVersions {
+public:
+	/** change_type: forward edge index and its new weight */
+	typedef std::pair<U_INT,U_INT> change_type;
+	typedef std::vector<change_type> BatchT;
+
+	WeightVersions(const U_INT* weights, size_t m) : hCurrent(0), hVersion(0) {
+		hBuf[0].assign(weights, weights+m);
+		hBuf[1] = hBuf[0];
+		hReaders[0] = hReaders[1] = 0;
+	}
+	~WeightVersions() {}
+
+	/**
+	 * Pin: slot of the current copy, it stays unchanged until Unpin
+	 */
+	size_t Pin(uint64_t& version) {
+		boost::mutex::scoped_lock lock(hMutex);
+		++hReaders[hCurrent];
+		version = hVersion;
+		return hCurrent;
+	}
+	void Unpin(size_t slot) {
+		boost::mutex::scoped_lock lock(hMutex);
+		if (!--hReaders[slot]) hDrained.notify_all();
+	}
+	const U_INT* Weights(size_t slot) const {
+		return hBuf[slot].empty() ? 0 : &hBuf[slot][0];
+	}
+	uint64_t Version() {
+		boost::mutex::scoped_lock lock(hMutex);
+		return hVersion;
+	}
+	/**
+	 * Apply: publish batch as the next version, returns it; writers are
+	 *        serialized, readers keep running
+	 */
+	uint64_t Apply(const BatchT& batch) {
+		boost::mutex::scoped_lock writer(hWriter);
+		size_t idle;
+		{
+			boost::mutex::scoped_lock lock(hMutex);
+			idle = 1 - hCurrent;
+			while (hReaders[idle]) hDrained.wait(lock);
+		}
+		std::vector<U_INT>& w = hBuf[idle];
+		for (size_t i=0; i<hLast.size(); ++i)
+			w[hLast[i].first] = hLast[i].second;
+		for (size_t i=0; i<batch.size(); ++i)
+			w[batch[i].first] = batch[i].second;
+		boost::mutex::scoped_lock lock(hMutex);
+		hCurrent = idle;
+		hLast = batch;
+		return ++hVersion;
+	}
+private:
+	WeightVersions(const WeightVersions&);
+	WeightVersions& operator=(const WeightVersions&);
+
+	std::vector<U_INT> hBuf[2];
+	size_t hReaders[2];
+	size_t hCurrent;
+	uint64_t hVersion;
+	BatchT hLast;
+	boost::mutex hMutex;
+	boost::mutex hWriter;
+	boost::condition hDrained;
+};
+
+/**
+ * WeightPin: scoped pin of the current weights, inactive when versions is
+ *   null so graphs without updates search their own arrays
+ */
+class WeightPin {
+public:
+	WeightPin(WeightVersions* versions) : hVersions(versions), hSlot(0), hVersion(0) {
+		if (hVersions) hSlot = hVersions->Pin(hVersion);
+	}
+	~WeightPin() {
+		if (hVersions) hVersions->Unpin(hSlot);
+	}
+	bool Active() const {
+		return hVersions != 0;
+	}
+	const U_INT* Weights() const {
+		return hVersions->Weights(hSlot);
+	}
+	uint64_t Version() const {
+		return hVersion;
+	}
+private:
+	WeightPin(const WeightPin&);
+	WeightPin& operator=(const WeightPin&);
+	WeightVersions* hVersions;
+	size_t hSlot;
+	uint64_t hVersion;
+};
+} // namespace TestAstar
+#endif
@@ -0,0 +1,52 @@
+#!/bin/sh
+if [ $# -lt 4 ] ; then
+	echo "Usage $0 PROGRAM GRAPHFILE COORDSFILE QUERYFILE [OPTIONS]"
+	echo "Notes: This programs checks the paths PROGRAM prints for QUERYFILE against dijkstra"
+	echo "PROGRAM - test_tway or test_astar, its -A one to all sweep gives the reference costs"
+	echo "OPTIONS - Search options of the checked run, the query paths must be shortest paths"
+	exit 1
+fi
+PROG=$1
+GRAPH=$2
+COORDS=$3
+QUERIES=$4
+shift 4
+REF=check_ref.$$
+OUT=check_out.$$
+trap 'rm -f $REF $OUT' 0
+$PROG -A $GRAPH $COORDS $QUERIES > $REF 2>&1 || { echo "$PROG -A failed"; exit 1; }
+$PROG "$@" $GRAPH $COORDS $QUERIES > $OUT 2>&1 || { echo "$PROG $* failed"; exit 1; }
+awk -v NAME="$PROG${*:+ $*}" '
+# cheapest arc between two vertices from the graph file
+FILENAME==ARGV[1] {
+	if ($1=="a" && (!(($2" "$3) in w) || $4<w[$2" "$3])) w[$2" "$3]=$4
+	next
+}
+# reference cost per query from the -A sweep, -1 when unreachable
+FILENAME==ARGV[2] {
+	if ($1 ~ /^\[/) cost[nref++]=$NF
+	next
+}
+$1 ~ /^\[/ {
+	s=substr($1,2); t=$3; sub(/\]$/,"",t)
+	n=0
+	for (i=4;i<=NF;++i) if ($i!="-") p[n++]=$i
+	q=nout++
+	if (n==0) {
+		if (cost[q]!=-1) { print NAME": no path "s" -> "t", cost "cost[q]; ++bad }
+		next
+	}
+	if (p[0]!=s || p[n-1]!=t) { print NAME": path "s" -> "t" has ends "p[0]" "p[n-1]; ++bad; next }
+	c=0
+	for (i=1;i<n;++i) {
+		if (!((p[i-1]" "p[i]) in w)) { print NAME": path "s" -> "t" uses no arc "p[i-1]" "p[i]; ++bad; next }
+		c+=w[p[i-1]" "p[i]]
+	}
+	++checked
+	if (c!=cost[q]) { print NAME": path "s" -> "t" costs "c", dijkstra "cost[q]; ++bad }
+}
+END {
+	if (nout!=nref) { print NAME": "nout" results for "nref" queries"; ++bad }
+	print NAME": checked "checked+0" bad "bad+0
+	exit (bad>0 || checked==0)
+}' $GRAPH $REF $OUT
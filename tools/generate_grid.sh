@@ -0,0 +1,50 @@
+#!/bin/sh
+if [ $# -lt 3 ] ; then
+	echo "Usage $0 SIDE COUNT PREFIX [SEED]"
+	echo "Notes: This programs writes a grid graph, its coordinates and a p2p problem file in dimacs format"
+	echo "SIDE - Number of nodes along each side of the square grid"
+	echo "COUNT - Number of problem lines to generate"
+	echo "PREFIX - Output files PREFIX.gr, PREFIX.co and PREFIX.p2p"
+	echo "SEED - Random seed, default 1"
+	exit 1
+fi
+awk -v SIDE=$1 -v COUNT=$2 -v PREFIX=$3 -v SEED=${4:-1} '
+BEGIN{
+if ((COUNT==0) || (SIDE<2)) {
+	print "c Error COUNT "COUNT
+	print "c Error SIDE "SIDE
+	exit(1)
+}
+srand(SEED);
+NODES=SIDE*SIDE
+ARCS=0
+# arcs in each direction kept and weighted on their own, some one way
+for (y=0;y<SIDE;++y) {
+	for (x=0;x<SIDE;++x) {
+		u=y*SIDE+x+1
+		if (x+1<SIDE) {
+			if (rand()<0.9) { a[ARCS++]=u" "(u+1)" "(10+int(rand()*21)) }
+			if (rand()<0.9) { a[ARCS++]=(u+1)" "u" "(10+int(rand()*21)) }
+		}
+		if (y+1<SIDE) {
+			if (rand()<0.9) { a[ARCS++]=u" "(u+SIDE)" "(10+int(rand()*21)) }
+			if (rand()<0.9) { a[ARCS++]=(u+SIDE)" "u" "(10+int(rand()*21)) }
+		}
+	}
+}
+gr=PREFIX".gr"
+print "c Generated grid graph "SIDE"x"SIDE > gr
+print "p sp "NODES" "ARCS > gr
+for (i=0;i<ARCS;++i) print "a "a[i] > gr
+co=PREFIX".co"
+print "c Generated grid coordinates "SIDE"x"SIDE > co
+print "p aux sp co "NODES > co
+for (y=0;y<SIDE;++y)
+	for (x=0;x<SIDE;++x)
+		print "v",y*SIDE+x+1,x*10+int(rand()*4),y*10+int(rand()*4) > co
+p2p=PREFIX".p2p"
+print "c Generated point-to-point problems" > p2p
+print "p aux sp p2p "COUNT > p2p
+for (i=0;i<COUNT;++i)
+	print "q",1+int(rand()*NODES),1+int(rand()*NODES) > p2p
+}'